@@ -0,0 +1,349 @@
+// Simulatie zonder venster of GL-context, voor benchmarks op build machines.
+// Schrijft de resultaten als JSON naar stdout (of naar --out).
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#else
+#include <sys/resource.h>
+#endif
+
+#include "Globals.h"
+#include "Simulation.h"
+#include "EventSimulation.h"
+#include "Benchmark.h"
+#include "KernelRegistry.h"
+#include "Profiler.h"
+#include "Trajectory.h"
+
+typedef std::chrono::steady_clock Clock;
+
+struct Sample {
+    long long step;
+    double seconds;
+    size_t balls;
+};
+
+static size_t peakRssBytes() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return counters.PeakWorkingSetSize;
+    return 0;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#ifdef __APPLE__
+    return static_cast<size_t>(usage.ru_maxrss);
+#else
+    return static_cast<size_t>(usage.ru_maxrss) * 1024;
+#endif
+#endif
+}
+
+static void printUsage() {
+    std::cerr << "Usage: Headless [--steps N] [--seconds T] [--threads N] [--sim-hz HZ]\n"
+        "                [--balls N] [--seed S] [--sample-every K] [--out FILE]\n"
+        "                [--trace FILE] [--engine step|event] [--broadphase grid|list]\n"
+        "                [--reorder on|off] [--contacts off|cold|warm] [--spawn origin|search]\n"
+        "                [--load CHECKPOINT] [--save CHECKPOINT] [--list-kernels] [--check-kernels]\n"
+        "                [--record FILE] [--record-keyframe K] [--read-trajectory FILE]\n";
+}
+
+// Decodeert een opname van --record helemaal en geeft een samenvatting als JSON.
+static int readTrajectory(const std::string& path) {
+    TrajectoryReader reader;
+    std::string error;
+    if (!reader.open(path, error)) {
+        std::cerr << "Cannot read trajectory: " << error << "\n";
+        return 1;
+    }
+    TrajectoryFrame frame;
+    unsigned long long frames = 0;
+    unsigned long long keyframes = 0;
+    unsigned long long ballFrames = 0;
+    unsigned long long firstStep = 0;
+    while (reader.next(frame, error)) {
+        if (frames == 0) firstStep = frame.step;
+        ++frames;
+        keyframes += frame.keyframe;
+        ballFrames += frame.x.size();
+    }
+    if (!error.empty()) {
+        std::cerr << "Cannot read trajectory: " << path << ": " << error << " after " << frames << " frames\n";
+        return 1;
+    }
+    std::ifstream file(path.c_str(), std::ios::binary | std::ios::ate);
+    const unsigned long long fileBytes = static_cast<unsigned long long>(file.tellg());
+    std::cout << "{\n"
+        << "  \"trajectory\": \"" << path << "\",\n"
+        << "  \"keyframe_every\": " << reader.keyframeEvery() << ",\n"
+        << "  \"frames\": " << frames << ",\n"
+        << "  \"keyframes\": " << keyframes << ",\n"
+        << "  \"first_step\": " << firstStep << ",\n"
+        << "  \"last_step\": " << (frames ? frame.step : 0) << ",\n"
+        << "  \"final_balls\": " << (frames ? frame.x.size() : 0) << ",\n"
+        << "  \"bytes\": " << fileBytes << ",\n"
+        << "  \"bytes_per_ball_frame\": " << (ballFrames ? static_cast<double>(fileBytes) / ballFrames : 0.0) << "\n"
+        << "}\n";
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    long long maxSteps = -1;
+    double maxSeconds = -1.0;
+    unsigned threads = defaultThreadCount();
+    double simHz = DEFAULT_SIM_HZ;
+    size_t initialBalls = 0;
+    uint64_t seed = 1;
+    long long sampleEvery = 60;
+    std::string outPath;
+    std::string tracePath;
+    std::string engine = "step";
+    std::string broadphase = "list";
+    std::string reorder = "on";
+    std::string contacts = "off";
+    std::string spawn = "search";
+    std::string loadPath;
+    std::string savePath;
+    std::string recordPath;
+    int recordKeyframe = TRAJECTORY_DEFAULT_KEYFRAME;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--steps" && hasValue) maxSteps = std::atoll(argv[++i]);
+        else if (arg == "--seconds" && hasValue) maxSeconds = std::atof(argv[++i]);
+        else if (arg == "--threads" && hasValue) threads = static_cast<unsigned>(std::atoi(argv[++i]));
+        else if (arg == "--sim-hz" && hasValue) simHz = std::atof(argv[++i]);
+        else if (arg == "--balls" && hasValue) initialBalls = static_cast<size_t>(std::atoll(argv[++i]));
+        else if (arg == "--seed" && hasValue) seed = std::strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--sample-every" && hasValue) sampleEvery = std::atoll(argv[++i]);
+        else if (arg == "--out" && hasValue) outPath = argv[++i];
+        else if (arg == "--trace" && hasValue) tracePath = argv[++i];
+        else if (arg == "--engine" && hasValue) engine = argv[++i];
+        else if (arg == "--broadphase" && hasValue) broadphase = argv[++i];
+        else if (arg == "--reorder" && hasValue) reorder = argv[++i];
+        else if (arg == "--contacts" && hasValue) contacts = argv[++i];
+        else if (arg == "--spawn" && hasValue) spawn = argv[++i];
+        else if (arg == "--load" && hasValue) loadPath = argv[++i];
+        else if (arg == "--save" && hasValue) savePath = argv[++i];
+        else if (arg == "--record" && hasValue) recordPath = argv[++i];
+        else if (arg == "--record-keyframe" && hasValue) recordKeyframe = std::atoi(argv[++i]);
+        else if (arg == "--read-trajectory" && hasValue) return readTrajectory(argv[++i]);
+        else if (arg == "--list-kernels") {
+            printKernels(std::cout);
+            return 0;
+        }
+        else if (arg == "--check-kernels") {
+            return checkWallKernels(std::cout) ? 0 : 1;
+        }
+        else {
+            printUsage();
+            return 1;
+        }
+    }
+    if (maxSteps < 0 && maxSeconds < 0.0) maxSteps = 1000;
+    if (simHz <= 0.0) simHz = DEFAULT_SIM_HZ;
+    if (sampleEvery <= 0) sampleEvery = 1;
+    if ((engine != "step" && engine != "event") || (broadphase != "grid" && broadphase != "list") ||
+        (reorder != "on" && reorder != "off") || (contacts != "off" && contacts != "cold" && contacts != "warm") ||
+        (spawn != "origin" && spawn != "search")) {
+        printUsage();
+        return 1;
+    }
+    if (initialBalls > BALL_STORE_MAX_BALLS) {
+        std::cerr << "--balls is at most " << BALL_STORE_MAX_BALLS << " in this build\n";
+        return 1;
+    }
+    const bool eventDriven = engine == "event";
+    if (eventDriven && (!loadPath.empty() || !savePath.empty())) {
+        std::cerr << "Checkpoints need --engine step\n";
+        return 1;
+    }
+    if (eventDriven && !recordPath.empty()) {
+        std::cerr << "--record needs --engine step\n";
+        return 1;
+    }
+
+    // Een van de twee draait; de event-engine is enkeldraads
+    Simulation sim(eventDriven ? 1 : threads, simHz, seed);
+    sim.setBroadphase(broadphase == "grid" ? Broadphase::Grid : Broadphase::NeighbourList);
+    sim.setReordering(reorder == "on");
+    sim.setContactMode(contacts == "warm" ? ContactMode::Warm : contacts == "cold" ? ContactMode::Cold : ContactMode::Off);
+    sim.setSpawnPlacement(spawn == "origin" ? SpawnPlacement::Origin : SpawnPlacement::Search);
+    EventSimulation eventSim(seed);
+    double loadMs = 0.0;
+    if (!loadPath.empty()) {
+        // Vervangt ook de seed; --balls telt dan niet
+        std::string error;
+        Clock::time_point loadStart = Clock::now();
+        if (!sim.loadCheckpoint(loadPath, error)) {
+            std::cerr << "Cannot load checkpoint: " << error << "\n";
+            return 1;
+        }
+        loadMs = std::chrono::duration<double, std::milli>(Clock::now() - loadStart).count();
+    }
+    else if (initialBalls > 0) {
+        BallStore start = randomBalls(initialBalls, static_cast<uint32_t>(seed));
+        if (eventDriven) eventSim.load(start);
+        else sim.load(start);
+    }
+    const BallStore& balls = eventDriven ? eventSim.balls() : sim.balls();
+
+    // Geen frame loop om voor te bewaken: wachten op de writer, zodat elke stap erin staat
+    TrajectoryRecorder recorder;
+    if (!recordPath.empty()) {
+        std::string error;
+        if (!recorder.start(recordPath, recordKeyframe, TrajectoryOverflow::Wait, error)) {
+            std::cerr << "Cannot record trajectory: " << error << "\n";
+            return 1;
+        }
+        recorder.record(sim);
+    }
+
+    std::vector<Sample> samples;
+    unsigned long long pairTests = 0;
+    unsigned long long collisions = 0;
+    unsigned long long wallHits = 0;
+    unsigned long long contactIterations = 0;
+    unsigned long long warmStarts = 0;
+
+    Clock::time_point start = Clock::now();
+    long long step = 0;
+    double elapsed = 0.0;
+    samples.push_back({ 0, 0.0, balls.size() });
+
+    for (;;) {
+        if (maxSteps >= 0 && step >= maxSteps) break;
+        if (maxSeconds >= 0.0 && elapsed >= maxSeconds) break;
+
+        if (eventDriven) {
+            // Springt in een keer naar het volgende sample; tussenliggende stappen bestaan niet
+            long long count = sampleEvery - step % sampleEvery;
+            if (maxSteps >= 0 && step + count > maxSteps) count = maxSteps - step;
+            {
+                PROFILE_SCOPE("step");
+                eventSim.advance(count * (SIM_REFERENCE_HZ / simHz));
+            }
+            step += count;
+            pairTests = eventSim.totals().pairTests;
+            collisions = eventSim.totals().collisions;
+            wallHits = eventSim.totals().wallHits;
+        }
+        else {
+            {
+                PROFILE_SCOPE("step");
+                sim.step();
+            }
+            ++step;
+            recorder.record(sim);
+            pairTests += sim.lastStats().pairTests;
+            collisions += sim.lastStats().collisions;
+            wallHits += sim.lastStats().wallHits;
+            contactIterations += sim.lastStats().contactIterations;
+            warmStarts += sim.lastStats().warmStarts;
+        }
+
+        elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+        if (step % sampleEvery == 0)
+            samples.push_back({ step, elapsed, balls.size() });
+    }
+    if (samples.back().step != step)
+        samples.push_back({ step, elapsed, balls.size() });
+
+    recorder.stop();
+
+    double saveMs = 0.0;
+    if (!savePath.empty()) {
+        std::string error;
+        Clock::time_point saveStart = Clock::now();
+        if (!sim.saveCheckpoint(savePath, error)) {
+            std::cerr << "Cannot save checkpoint: " << error << "\n";
+            return 1;
+        }
+        saveMs = std::chrono::duration<double, std::milli>(Clock::now() - saveStart).count();
+    }
+
+    if (!tracePath.empty() && !profilerWriteChromeTrace(tracePath.c_str()))
+        std::cerr << "Cannot write trace " << tracePath << " (built without BALLS_PROFILE?)\n";
+
+    std::ostringstream json;
+    json << "{\n"
+        << "  \"engine\": \"" << engine << "\",\n"
+        << "  \"wall_kernel\": \"" << sim.wallKernel().name << "\",\n"
+        << "  \"pair_kernel\": \"" << sim.pairKernel().name << "\",\n"
+        << "  \"threads\": " << sim.threadCount() << ",\n"
+        << "  \"sim_hz\": " << simHz << ",\n"
+        << "  \"seed\": " << (eventDriven ? seed : sim.seed()) << ",\n"
+        << "  \"steps\": " << step << ",\n"
+        << "  \"seconds\": " << elapsed << ",\n"
+        << "  \"steps_per_sec\": " << (elapsed > 0.0 ? step / elapsed : 0.0) << ",\n"
+        << "  \"final_balls\": " << balls.size() << ",\n"
+        << "  \"pair_tests\": " << pairTests << ",\n"
+        << "  \"collisions\": " << collisions << ",\n"
+        << "  \"wall_hits\": " << wallHits << ",\n";
+    if (!eventDriven) {
+        json << "  \"broadphase\": \"" << broadphase << "\",\n"
+            << "  \"neighbour_rebuilds\": " << sim.neighbourRebuilds() << ",\n"
+            << "  \"steps_per_rebuild\": "
+            << (sim.neighbourRebuilds() ? static_cast<double>(step) / sim.neighbourRebuilds() : 0.0) << ",\n"
+            << "  \"reorders\": " << sim.reorderCount() << ",\n"
+            << "  \"contacts\": \"" << contacts << "\",\n"
+            << "  \"contact_iterations\": " << contactIterations << ",\n"
+            << "  \"warm_starts\": " << warmStarts << ",\n"
+            << "  \"spawn\": \"" << spawn << "\",\n"
+            << "  \"spawns_pending\": " << sim.pendingSpawns() << ",\n"
+            << "  \"spawns_dropped\": " << sim.spawnsDropped() << ",\n";
+        if (!loadPath.empty())
+            json << "  \"checkpoint_loaded\": \"" << loadPath << "\",\n"
+                << "  \"checkpoint_load_ms\": " << loadMs << ",\n";
+        if (!savePath.empty())
+            json << "  \"checkpoint_saved\": \"" << savePath << "\",\n"
+                << "  \"checkpoint_save_ms\": " << saveMs << ",\n";
+        if (!recordPath.empty())
+            json << "  \"trajectory\": \"" << recordPath << "\",\n"
+                << "  \"trajectory_frames\": " << recorder.framesWritten() << ",\n"
+                << "  \"trajectory_dropped\": " << recorder.framesDropped() << ",\n"
+                << "  \"trajectory_bytes\": " << recorder.bytesWritten() << ",\n";
+    }
+    if (eventDriven) {
+        json << "  \"events\": " << eventSim.totals().events << ",\n"
+            << "  \"cell_crossings\": " << eventSim.totals().cellCrossings << ",\n"
+            << "  \"stale_events\": " << eventSim.totals().staleEvents << ",\n"
+            << "  \"spawns_dropped\": " << eventSim.totals().spawnsDropped << ",\n";
+    }
+    json << "  \"peak_rss_bytes\": " << peakRssBytes() << ",\n"
+        << "  \"ball_count\": [";
+    for (size_t i = 0; i < samples.size(); ++i) {
+        json << (i ? ",\n" : "\n")
+            << "    { \"step\": " << samples[i].step
+            << ", \"seconds\": " << samples[i].seconds
+            << ", \"balls\": " << samples[i].balls << " }";
+    }
+    json << "\n  ]\n}\n";
+
+    if (outPath.empty()) {
+        std::cout << json.str();
+    }
+    else {
+        std::ofstream out(outPath.c_str());
+        if (!out) {
+            std::cerr << "Cannot write " << outPath << "\n";
+            return 1;
+        }
+        out << json.str();
+    }
+    return 0;
+}
@@ -0,0 +1,393 @@
+// Micro-benchmarks voor losse bouwstenen van de simulatie: de botsing, de
+// cirkelgeometrie, de wandkernels en de opbouw van beide broadphases.
+// Schrijft de resultaten als JSON naar stdout (of naar --out); met --baseline
+// staat bij elke meting ook de verhouding tot een eerdere run.
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "Globals.h"
+#include "BallStore.h"
+#include "Benchmark.h"
+#include "CpuFeatures.h"
+#include "Geometry.h"
+#include "Grid.h"
+#include "KernelRegistry.h"
+#include "NeighbourList.h"
+#include "Physics.h"
+#include "WallKernel.h"
+
+#if BALLS_X86 && !defined(_MSC_VER)
+#include <x86intrin.h>
+#endif
+
+typedef std::chrono::steady_clock Clock;
+
+// Een opbouw van de buurlijst met meer kandidaatparen dan dit wordt
+// overgeslagen: alle ballen op de oorsprong geven n^2 / 2 paren.
+constexpr double LIST_CANDIDATE_BUDGET = 1e8;
+constexpr int MIN_REPS = 5;
+
+struct BenchConfig {
+    int warmup = 3;
+    int reps = 30;
+    double secondsPerCase = 2.0; // minder herhalingen als een meting langer duurt
+    std::string filter;
+};
+
+struct CaseResult {
+    std::string name;
+    const char* item = "ball"; // waar de kosten per stuk over gaan
+    size_t items = 0;
+    int reps = 0;
+    double medianNs = 0.0;
+    double p99Ns = 0.0;
+    double minNs = 0.0;
+    double cyclesPerItem = -1.0; // < 0: geen tijdstempelteller
+    std::string skipped;
+};
+
+// Tijdstempelteller van de CPU. Die loopt op een vaste frequentie en niet mee
+// met turbo of stroombesparing, dus "cycles" zijn nominale cycles.
+static bool haveCycleCounter() {
+    return BALLS_X86 != 0;
+}
+
+static uint64_t readCycles() {
+#if BALLS_X86
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+static double percentile(std::vector<double> values, double p) {
+    std::sort(values.begin(), values.end());
+    size_t rank = static_cast<size_t>(p * values.size());
+    if (rank >= values.size()) rank = values.size() - 1;
+    return values[rank];
+}
+
+static double median(std::vector<double> values) {
+    std::sort(values.begin(), values.end());
+    size_t mid = values.size() / 2;
+    return values.size() % 2 ? values[mid] : 0.5 * (values[mid - 1] + values[mid]);
+}
+
+// Draait setup (niet gemeten) en body (gemeten) eerst warmup keer en dan tot
+// config.reps keer, minder als dat langer dan secondsPerCase zou duren.
+template <typename Setup, typename Body>
+static CaseResult measure(const BenchConfig& config, const std::string& name, const char* item, size_t items,
+    Setup setup, Body body) {
+    CaseResult result;
+    result.name = name;
+    result.item = item;
+    result.items = items;
+
+    double warmupSeconds = 0.0;
+    const int warmup = std::max(config.warmup, 1);
+    for (int r = 0; r < warmup; ++r) {
+        setup();
+        Clock::time_point t0 = Clock::now();
+        body();
+        warmupSeconds = std::chrono::duration<double>(Clock::now() - t0).count();
+    }
+    int reps = config.reps;
+    if (warmupSeconds > 0.0 && warmupSeconds * reps > config.secondsPerCase)
+        reps = std::max(MIN_REPS, static_cast<int>(config.secondsPerCase / warmupSeconds));
+
+    std::vector<double> ns(reps);
+    std::vector<double> cycles(reps);
+    for (int r = 0; r < reps; ++r) {
+        setup();
+        Clock::time_point t0 = Clock::now();
+        uint64_t c0 = readCycles();
+        body();
+        uint64_t c1 = readCycles();
+        ns[r] = std::chrono::duration<double, std::nano>(Clock::now() - t0).count();
+        cycles[r] = static_cast<double>(c1 - c0);
+    }
+    result.reps = reps;
+    result.medianNs = median(ns);
+    result.p99Ns = percentile(ns, 0.99);
+    result.minNs = *std::min_element(ns.begin(), ns.end());
+    if (haveCycleCounter() && items > 0)
+        result.cyclesPerItem = median(cycles) / items;
+    return result;
+}
+
+static bool selected(const BenchConfig& config, const std::string& name) {
+    return config.filter.empty() || name.find(config.filter) != std::string::npos;
+}
+
+// Houdt de compiler ervan af om ongebruikte resultaten weg te laten.
+static volatile size_t sink = 0;
+
+// Paren die elkaar half overlappen en naar elkaar toe bewegen, zodat elke
+// aanroep de volledige botsing uitrekent.
+static void benchResolveCollision(const BenchConfig& config, std::vector<CaseResult>& results) {
+    const size_t pairs = 4096;
+    const std::string name = "resolve_collision/" + std::to_string(pairs);
+    if (!selected(config, name)) return;
+
+    BallStore pristine = randomBalls(pairs, 99);
+    BallStore start;
+    start.reserve(2 * pairs);
+    for (size_t k = 0; k < pairs; ++k) {
+        Ball a = pristine.get(k);
+        Ball b = { a.x + 1.5f * BALL_RADIUS, a.y + 0.5f * BALL_RADIUS, -a.vx, -a.vy };
+        a.vx = INITIAL_SPEED;
+        b.vx = -INITIAL_SPEED;
+        start.push(a);
+        start.push(b);
+    }
+    BallStore balls;
+    results.push_back(measure(config, name, "pair", pairs,
+        [&] { balls = start; },
+        [&] {
+            for (size_t k = 0; k < pairs; ++k)
+                resolveBallCollision(balls, 2 * k, 2 * k + 1);
+        }));
+}
+
+static void benchCircleVertices(const BenchConfig& config, std::vector<CaseResult>& results) {
+    const int calls = 100;
+    const std::string name = "circle_vertices/" + std::to_string(CIRCLE_SEGMENTS);
+    if (!selected(config, name)) return;
+
+    results.push_back(measure(config, name, "vertex", static_cast<size_t>(calls) * (CIRCLE_SEGMENTS + 1),
+        [] {},
+        [&] {
+            for (int c = 0; c < calls; ++c)
+                sink += generateCircleVertices(CIRCLE_RADIUS, CIRCLE_SEGMENTS).size();
+        }));
+}
+
+// Elke variant die de CPU aankan, ook boven BALLS_ISA: hier gaat het juist om
+// de verschillen. Zonder herstel tussen de herhalingen; de ballen blijven in de
+// arena en de kosten hangen niet van hun plaats af.
+static void benchWallKernels(const BenchConfig& config, const size_t* counts, size_t countCount,
+    std::vector<CaseResult>& results) {
+    for (size_t c = 0; c < countCount; ++c) {
+        const size_t n = counts[c];
+        BallStore balls;
+        std::vector<uint32_t> hits(n);
+        for (size_t k = 0; k < WALL_KERNEL_COUNT; ++k) {
+            const KernelVariant<WallKernelFn>& variant = WALL_KERNELS[k];
+            const std::string name = std::string("wall/") + kernelIsaName(variant.isa) + "/" + std::to_string(n);
+            if (!selected(config, name)) continue;
+            if (!kernelIsaSupported(variant.isa)) {
+                CaseResult skipped;
+                skipped.name = name;
+                skipped.skipped = "not supported by this cpu";
+                results.push_back(skipped);
+                continue;
+            }
+            if (balls.size() != n) balls = randomBalls(n, 1234);
+            results.push_back(measure(config, name, "ball", n,
+                [] {},
+                [&] { sink += variant.fn(balls, 0, n, 1.0f, hits.data()); }));
+        }
+    }
+}
+
+// Paren die NeighbourList::build met de afstand moet testen, geteld per cel
+// zoals buildCell ze afloopt.
+static double listCandidates(const BallStore& balls) {
+    std::vector<double> perCell(NEIGHBOUR_CELL_COUNT, 0.0);
+    for (size_t i = 0; i < balls.size(); ++i) {
+        int cx = std::min(std::max(static_cast<int>((balls.x()[i] + CIRCLE_RADIUS) / NEIGHBOUR_CUTOFF), 0),
+            NEIGHBOUR_GRID_DIM - 1);
+        int cy = std::min(std::max(static_cast<int>((balls.y()[i] + CIRCLE_RADIUS) / NEIGHBOUR_CUTOFF), 0),
+            NEIGHBOUR_GRID_DIM - 1);
+        perCell[cy * NEIGHBOUR_GRID_DIM + cx] += 1.0;
+    }
+    double candidates = 0.0;
+    for (int cell = 0; cell < NEIGHBOUR_CELL_COUNT; ++cell) {
+        double here = perCell[cell];
+        if (here == 0.0) continue;
+        candidates += here * (here - 1.0) / 2.0;
+        int cx = cell % NEIGHBOUR_GRID_DIM;
+        int cy = cell / NEIGHBOUR_GRID_DIM;
+        for (int ny = std::max(cy - 1, 0); ny <= std::min(cy + 1, NEIGHBOUR_GRID_DIM - 1); ++ny)
+            for (int nx = std::max(cx - 1, 0); nx <= std::min(cx + 1, NEIGHBOUR_GRID_DIM - 1); ++nx)
+                if (ny * NEIGHBOUR_GRID_DIM + nx > cell) candidates += here * perCell[ny * NEIGHBOUR_GRID_DIM + nx];
+    }
+    return candidates;
+}
+
+// Enkeldraads, zodat de opbouw zelf gemeten wordt en niet de pool.
+static void benchBroadphaseBuilds(const BenchConfig& config, const size_t* counts, size_t countCount,
+    std::vector<CaseResult>& results) {
+    const char* distributions[] = { "uniform", "clustered", "origin" };
+    for (const char* distribution : distributions) {
+        for (size_t c = 0; c < countCount; ++c) {
+            const size_t n = counts[c];
+            const std::string suffix = std::string("/") + distribution + "/" + std::to_string(n);
+            const std::string gridName = "grid_build" + suffix;
+            const std::string listName = "list_build" + suffix;
+            if (!selected(config, gridName) && !selected(config, listName)) continue;
+
+            const std::string kind = distribution;
+            BallStore balls = kind == "uniform" ? randomBalls(n, 1234)
+                : kind == "clustered" ? clusteredBalls(n, 1234) : originBalls(n, 1234);
+
+            if (selected(config, gridName)) {
+                UniformGrid grid;
+                results.push_back(measure(config, gridName, "ball", n,
+                    [] {},
+                    [&] { grid.build(balls); }));
+            }
+            if (selected(config, listName)) {
+                double candidates = listCandidates(balls);
+                if (candidates > LIST_CANDIDATE_BUDGET) {
+                    CaseResult skipped;
+                    skipped.name = listName;
+                    skipped.items = n;
+                    std::ostringstream reason;
+                    reason << static_cast<unsigned long long>(candidates) << " candidate pairs, budget "
+                        << static_cast<unsigned long long>(LIST_CANDIDATE_BUDGET);
+                    skipped.skipped = reason.str();
+                    results.push_back(skipped);
+                    continue;
+                }
+                NeighbourList list;
+                results.push_back(measure(config, listName, "ball", n,
+                    [] {},
+                    [&] { list.build(balls); }));
+            }
+        }
+    }
+}
+
+// Mediaan per naam uit een eerdere run. Leest alleen het eigen formaat: een
+// meting per regel.
+static bool readBaseline(const std::string& path, std::vector<std::pair<std::string, double>>& baseline) {
+    std::ifstream in(path.c_str());
+    if (!in) return false;
+    const std::string nameKey = "\"name\": \"";
+    const std::string medianKey = "\"median_ns\": ";
+    std::string line;
+    while (std::getline(in, line)) {
+        size_t name = line.find(nameKey);
+        size_t med = line.find(medianKey);
+        if (name == std::string::npos || med == std::string::npos) continue;
+        name += nameKey.size();
+        size_t nameEnd = line.find('"', name);
+        if (nameEnd == std::string::npos) continue;
+        baseline.push_back({ line.substr(name, nameEnd - name), std::atof(line.c_str() + med + medianKey.size()) });
+    }
+    return true;
+}
+
+static void printUsage() {
+    std::cerr << "Usage: MicroBench [--warmup N] [--reps N] [--seconds T] [--max-balls N]\n"
+        "                  [--filter TEXT] [--out FILE] [--baseline FILE] [--list-kernels]\n";
+}
+
+int main(int argc, char** argv) {
+    BenchConfig config;
+    size_t maxBalls = 1000000;
+    std::string outPath;
+    std::string baselinePath;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--warmup" && hasValue) config.warmup = std::atoi(argv[++i]);
+        else if (arg == "--reps" && hasValue) config.reps = std::atoi(argv[++i]);
+        else if (arg == "--seconds" && hasValue) config.secondsPerCase = std::atof(argv[++i]);
+        else if (arg == "--max-balls" && hasValue) maxBalls = static_cast<size_t>(std::atoll(argv[++i]));
+        else if (arg == "--filter" && hasValue) config.filter = argv[++i];
+        else if (arg == "--out" && hasValue) outPath = argv[++i];
+        else if (arg == "--baseline" && hasValue) baselinePath = argv[++i];
+        else if (arg == "--list-kernels") {
+            printKernels(std::cout);
+            return 0;
+        }
+        else {
+            printUsage();
+            return 1;
+        }
+    }
+    if (config.reps < MIN_REPS) config.reps = MIN_REPS;
+
+    std::vector<std::pair<std::string, double>> baseline;
+    if (!baselinePath.empty() && !readBaseline(baselinePath, baseline)) {
+        std::cerr << "Cannot read baseline " << baselinePath << "\n";
+        return 1;
+    }
+
+    const size_t allCounts[] = { 1000, 10000, 100000, 1000000 };
+    size_t counts[4];
+    size_t countCount = 0;
+    for (size_t n : allCounts)
+        if (n <= maxBalls) counts[countCount++] = n;
+
+    std::vector<CaseResult> results;
+    benchResolveCollision(config, results);
+    benchCircleVertices(config, results);
+    benchWallKernels(config, counts, countCount, results);
+    benchBroadphaseBuilds(config, counts, countCount, results);
+
+    std::ostringstream json;
+    json << "{\n"
+        << "  \"wall_kernel\": \"" << selectWallKernel().name << "\",\n"
+        << "  \"cycle_counter\": " << (haveCycleCounter() ? "\"tsc\"" : "null") << ",\n"
+        << "  \"warmup\": " << config.warmup << ",\n"
+        << "  \"max_reps\": " << config.reps << ",\n"
+        << "  \"seconds_per_case\": " << config.secondsPerCase << ",\n"
+        << "  \"cases\": [";
+    int slower = 0;
+    for (size_t k = 0; k < results.size(); ++k) {
+        const CaseResult& r = results[k];
+        json << (k ? ",\n" : "\n") << "    { \"name\": \"" << r.name << "\"";
+        if (!r.skipped.empty()) {
+            json << ", \"skipped\": \"" << r.skipped << "\" }";
+            continue;
+        }
+        json << ", \"item\": \"" << r.item << "\""
+            << ", \"items\": " << r.items
+            << ", \"reps\": " << r.reps
+            << ", \"median_ns\": " << r.medianNs
+            << ", \"p99_ns\": " << r.p99Ns
+            << ", \"min_ns\": " << r.minNs
+            << ", \"ns_per_item\": " << r.medianNs / r.items
+            << ", \"cycles_per_item\": ";
+        if (r.cyclesPerItem >= 0.0) json << r.cyclesPerItem;
+        else json << "null";
+        for (const std::pair<std::string, double>& b : baseline) {
+            if (b.first != r.name || b.second <= 0.0) continue;
+            double speedup = b.second / r.medianNs;
+            json << ", \"baseline_median_ns\": " << b.second << ", \"speedup\": " << speedup;
+            // Alleen een melding; ruis van een paar procent is normaal
+            if (speedup < 0.9) {
+                std::cerr << r.name << ": " << r.medianNs << " ns, baseline " << b.second << " ns\n";
+                ++slower;
+            }
+            break;
+        }
+        json << " }";
+    }
+    json << "\n  ]\n}\n";
+    if (slower) std::cerr << slower << " case(s) more than 10% slower than the baseline\n";
+
+    if (outPath.empty()) {
+        std::cout << json.str();
+    }
+    else {
+        std::ofstream out(outPath.c_str());
+        if (!out) {
+            std::cerr << "Cannot write " << outPath << "\n";
+            return 1;
+        }
+        out << json.str();
+    }
+    return 0;
+}
@@ -0,0 +1,47 @@
+#include "AllocationCounter.h"
+
+#ifdef BALLS_COUNT_ALLOCS
+
+#include <cstdlib>
+#include <new>
+
+// Triviaal type zonder constructor, dus veilig vanuit operator new zelf
+static thread_local uint64_t allocations = 0;
+
+static void* countedAlloc(size_t size) {
+    ++allocations;
+    void* p = std::malloc(size ? size : 1);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void* operator new(size_t size) { return countedAlloc(size); }
+void* operator new[](size_t size) { return countedAlloc(size); }
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    ++allocations;
+    return std::malloc(size ? size : 1);
+}
+
+void* operator new[](size_t size, const std::nothrow_t& tag) noexcept {
+    return operator new(size, tag);
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { std::free(p); }
+
+uint64_t allocationCount() {
+    return allocations;
+}
+
+#else
+
+uint64_t allocationCount() {
+    return 0;
+}
+
+#endif
@@ -0,0 +1,9 @@
+#pragma once
+
+#include <cstdint>
+
+// Telt heap-allocaties via de globale operator new, per thread: de teller van
+// de aanroepende thread, zodat de simulatie- en de GL-thread elk hun eigen
+// stappen controleren. Alleen actief met BALLS_COUNT_ALLOCS (Debug); anders
+// geeft dit altijd 0.
+uint64_t allocationCount();
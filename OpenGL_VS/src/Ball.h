@@ -1,6 +1,21 @@
 #pragma once
 
+#include <cstdint>
+
 struct Ball {
     float x, y;
     float vx, vy;
 };
+
+// Wat de renderer per bal tekent: de positie en een id dat bij de bal blijft,
+// ook als de simulatie de ballen in het geheugen herordent.
+struct BallInstance {
+    float x, y;
+    uint32_t id;
+};
+
+// Twee ball-indices die tegen elkaar getest moeten worden.
+struct BallPair {
+    uint32_t i;
+    uint32_t j;
+};
@@ -0,0 +1,135 @@
+#include "BallOrder.h"
+#include "Grid.h"
+#include "ThreadPool.h"
+#include "Profiler.h"
+
+// Bits per celcoordinaat en per radix-cijfer
+constexpr int MORTON_AXIS_BITS = GRID_DIM <= 64 ? 6 : GRID_DIM <= 128 ? 7 : 8;
+constexpr int MORTON_KEY_BITS = 2 * MORTON_AXIS_BITS;
+constexpr int RADIX_BITS = 8;
+constexpr uint32_t RADIX_BUCKETS = 1u << RADIX_BITS;
+constexpr int RADIX_PASSES = (MORTON_KEY_BITS + RADIX_BITS - 1) / RADIX_BITS;
+static_assert(GRID_DIM <= 256, "celcoordinaten passen niet in de Morton-sleutel");
+static_assert(RADIX_PASSES % 2 == 0, "het resultaat moet na de laatste pass in keys[0] staan");
+
+// Zet de bits van v op de even posities: ...b2 b1 b0 -> ...0 b2 0 b1 0 b0
+static uint32_t spreadBits(uint32_t v) {
+    v = (v | (v << 4)) & 0x0f0fu;
+    v = (v | (v << 2)) & 0x3333u;
+    v = (v | (v << 1)) & 0x5555u;
+    return v;
+}
+
+uint32_t mortonCellKey(float x, float y) {
+    return spreadBits(static_cast<uint32_t>(gridCellCoord(x))) |
+        (spreadBits(static_cast<uint32_t>(gridCellCoord(y))) << 1);
+}
+
+// Verdeelt [0, n) in een stuk per thread; zonder pool of met weinig ballen is
+// er een stuk en draait alles op de aanroepende thread.
+template <typename Fn>
+static size_t forEachChunk(ThreadPool* pool, size_t n, size_t& grain, const Fn& fn) {
+    if (!pool || pool->threadCount() == 1 || n < 4096) {
+        grain = n ? n : 1;
+        fn(0, n);
+        return 1;
+    }
+    const size_t chunkCount = pool->threadCount();
+    grain = (n + chunkCount - 1) / chunkCount;
+    pool->parallelFor(n, grain, [&](size_t begin, size_t end, unsigned) { fn(begin, end); });
+    return chunkCount;
+}
+
+float BallOrder::locality(const BallStore& balls, ThreadPool* pool) {
+    PROFILE_SCOPE("locality");
+    const size_t n = balls.size();
+    if (n < 2) return 1.0f;
+
+    Span<const float> x = balls.x();
+    Span<const float> y = balls.y();
+    const size_t maxChunks = pool ? pool->threadCount() : 1;
+    chunkCounts.assign(maxChunks, 0);
+
+    // Elk stuk telt de paren (i, i + 1) met i in het stuk
+    size_t grain = 0;
+    size_t chunks = forEachChunk(pool, n - 1, grain, [&](size_t begin, size_t end) {
+        uint32_t near = 0;
+        int cx = gridCellCoord(x[begin]);
+        int cy = gridCellCoord(y[begin]);
+        for (size_t i = begin; i < end; ++i) {
+            int nx = gridCellCoord(x[i + 1]);
+            int ny = gridCellCoord(y[i + 1]);
+            if (nx - cx <= 1 && cx - nx <= 1 && ny - cy <= 1 && cy - ny <= 1) ++near;
+            cx = nx;
+            cy = ny;
+        }
+        chunkCounts[begin / grain] = near;
+    });
+
+    uint64_t near = 0;
+    for (size_t c = 0; c < chunks; ++c)
+        near += chunkCounts[c];
+    return static_cast<float>(static_cast<double>(near) / (n - 1));
+}
+
+const uint32_t* BallOrder::sort(const BallStore& balls, ThreadPool* pool) {
+    PROFILE_SCOPE("reorder");
+    const size_t n = balls.size();
+    for (int b = 0; b < 2; ++b) {
+        keys[b].reserve(n);
+        order[b].reserve(n);
+    }
+
+    Span<const float> x = balls.x();
+    Span<const float> y = balls.y();
+    size_t grain = 0;
+    forEachChunk(pool, n, grain, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            keys[0][i] = mortonCellKey(x[i], y[i]);
+            order[0][i] = static_cast<uint32_t>(i);
+        }
+    });
+
+    // Heen en weer tussen de twee buffers; elke pass is stabiel, dus ballen in
+    // dezelfde cel houden hun onderlinge volgorde.
+    for (int pass = 0; pass < RADIX_PASSES; ++pass) {
+        int from = pass & 1;
+        radixPass(n, pass * RADIX_BITS, keys[from].data(), order[from].data(),
+            keys[from ^ 1].data(), order[from ^ 1].data(), pool);
+    }
+    return order[0].data();
+}
+
+// Een counting sort op het cijfer (key >> shift) & 0xff, zoals
+// UniformGrid::build: een histogram per stuk en een prefix sum over
+// (cijfer, stuk) geven elk stuk zijn eigen schrijfposities.
+void BallOrder::radixPass(size_t n, int shift, const uint32_t* keysIn, const uint32_t* orderIn,
+    uint32_t* keysOut, uint32_t* orderOut, ThreadPool* pool) {
+    const size_t maxChunks = pool ? pool->threadCount() : 1;
+    chunkCounts.assign(maxChunks * RADIX_BUCKETS, 0);
+
+    size_t grain = 0;
+    size_t chunks = forEachChunk(pool, n, grain, [&](size_t begin, size_t end) {
+        uint32_t* counts = &chunkCounts[(begin / grain) * RADIX_BUCKETS];
+        for (size_t i = begin; i < end; ++i)
+            ++counts[(keysIn[i] >> shift) & (RADIX_BUCKETS - 1)];
+    });
+
+    uint32_t offset = 0;
+    for (uint32_t d = 0; d < RADIX_BUCKETS; ++d) {
+        for (size_t k = 0; k < chunks; ++k) {
+            uint32_t count = chunkCounts[k * RADIX_BUCKETS + d];
+            chunkCounts[k * RADIX_BUCKETS + d] = offset;
+            offset += count;
+        }
+    }
+
+    forEachChunk(pool, n, grain, [&](size_t begin, size_t end) {
+        uint32_t* next = &chunkCounts[(begin / grain) * RADIX_BUCKETS];
+        for (size_t i = begin; i < end; ++i) {
+            uint32_t slot = next[(keysIn[i] >> shift) & (RADIX_BUCKETS - 1)]++;
+            keysOut[slot] = keysIn[i];
+            orderOut[slot] = orderIn[i];
+        }
+    });
+}
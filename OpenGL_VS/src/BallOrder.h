@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "BallStore.h"
+#include "VirtualArray.h"
+
+class ThreadPool;
+
+// Morton-index (Z-order) van de gridcel van een positie: de bits van de
+// kolom en de rij om en om. Cellen die dicht bij elkaar liggen krijgen meestal
+// een sleutel die dicht bij elkaar ligt.
+uint32_t mortonCellKey(float x, float y);
+
+// Bepaalt een geheugenvolgorde voor de ballen waarin buren in de arena ook in
+// de arrays naast elkaar liggen, zodat de broadphase minder cache misses heeft.
+class BallOrder {
+public:
+    // Fractie van de opeenvolgende ballen (i, i + 1) die in dezelfde of een
+    // aangrenzende gridcel liggen. Daalt als ballen van cel wisselen.
+    float locality(const BallStore& balls, ThreadPool* pool = nullptr);
+
+    // Stabiele LSD radix sort op Morton-sleutel. Geeft order terug met
+    // order[nieuw] = oud; geldig tot de volgende aanroep.
+    const uint32_t* sort(const BallStore& balls, ThreadPool* pool = nullptr);
+
+private:
+    void radixPass(size_t n, int shift, const uint32_t* keysIn, const uint32_t* orderIn,
+        uint32_t* keysOut, uint32_t* orderOut, ThreadPool* pool);
+
+    VirtualArray<uint32_t> keys[2];
+    VirtualArray<uint32_t> order[2];
+    std::vector<uint32_t> chunkCounts; // histogram per stuk en per cijfer
+};
@@ -0,0 +1,144 @@
+#include "BallRenderer.h"
+#include "Globals.h"
+#include "Utils.h"
+#include <cstddef>
+#include <vector>
+
+static const char* ballVertexShaderSource = R"(
+    #version 330 core
+    layout (location = 0) in vec2 aPos;
+    layout (location = 1) in vec2 aOffset;
+    layout (location = 2) in uint aId;
+    out vec2 FragPos;
+    out vec3 Color;
+    void main() {
+        FragPos = aPos;
+        Color = (aId % 10u == 0u) ? vec3(0.2, 1.0, 0.5) : vec3(1.0, 0.5, 0.2);
+        gl_Position = vec4(aPos + aOffset, 0.0, 1.0);
+    }
+)";
+
+static const char* fanFragmentShaderSource = R"(
+    #version 330 core
+    in vec2 FragPos;
+    in vec3 Color;
+    out vec4 FragColor;
+    void main() {
+        float dist = length(FragPos * 30.0);
+        float intensity = 1.0 - dist;
+        intensity = clamp(intensity, 0.0, 1.0);
+        FragColor = vec4(Color * intensity, 1.0);
+    }
+)";
+
+// Zelfde verloop als de waaier; de rand van de schijf volgt uit de afstand
+// tot het midden, met een pixel anti-aliasing via fwidth.
+static const char* quadFragmentShaderSource = R"(
+    #version 330 core
+    in vec2 FragPos;
+    in vec3 Color;
+    out vec4 FragColor;
+    uniform float radius;
+    void main() {
+        float d = length(FragPos);
+        float coverage = clamp((radius - d) / fwidth(d) + 0.5, 0.0, 1.0);
+        if (coverage <= 0.0) discard;
+        float intensity = clamp(1.0 - d * 30.0, 0.0, 1.0);
+        FragColor = vec4(Color * intensity, coverage);
+    }
+)";
+
+const char* ballRenderModeName(BallRenderMode mode) {
+    return mode == BallRenderMode::Fan ? "fan" : "quad";
+}
+
+BallRenderer::BallRenderer() {
+    instances.create(GL_ARRAY_BUFFER);
+
+    std::vector<float> fanVertices = generateCircleVertices(BALL_RADIUS, CIRCLE_SEGMENTS);
+    createShape(fan, fanFragmentShaderSource, fanVertices.data(), fanVertices.size(), GL_TRIANGLE_FAN);
+
+    // Iets groter dan de bal zodat de anti-aliasing van de rand erin past
+    const float r = BALL_RADIUS * 1.1f;
+    const float quadVertices[] = { -r, -r, r, -r, -r, r, r, r };
+    createShape(quad, quadFragmentShaderSource, quadVertices, 8, GL_TRIANGLE_STRIP);
+    glUseProgram(quad.program);
+    glUniform1f(glGetUniformLocation(quad.program, "radius"), BALL_RADIUS);
+}
+
+void BallRenderer::createShape(Shape& shape, const char* fragmentSource, const float* vertices, size_t floatCount, GLenum primitive) {
+    GLuint vertexShader = compileShader(GL_VERTEX_SHADER, ballVertexShaderSource);
+    GLuint fragmentShader = compileShader(GL_FRAGMENT_SHADER, fragmentSource);
+    shape.program = glCreateProgram();
+    glAttachShader(shape.program, vertexShader);
+    glAttachShader(shape.program, fragmentShader);
+    glLinkProgram(shape.program);
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
+
+    shape.primitive = primitive;
+    shape.vertexCount = static_cast<GLsizei>(floatCount / 2);
+
+    glGenVertexArrays(1, &shape.vao);
+    glGenBuffers(1, &shape.vbo);
+    glBindVertexArray(shape.vao);
+
+    glBindBuffer(GL_ARRAY_BUFFER, shape.vbo);
+    glBufferData(GL_ARRAY_BUFFER, floatCount * sizeof(float), vertices, GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+
+    glEnableVertexAttribArray(1);
+    glVertexAttribDivisor(1, 1);
+    glEnableVertexAttribArray(2);
+    glVertexAttribDivisor(2, 1);
+
+    glBindVertexArray(0);
+}
+
+void BallRenderer::destroyShape(Shape& shape) {
+    glDeleteBuffers(1, &shape.vbo);
+    glDeleteVertexArrays(1, &shape.vao);
+    glDeleteProgram(shape.program);
+    shape = Shape();
+}
+
+void BallRenderer::destroy() {
+    instances.destroy();
+    destroyShape(fan);
+    destroyShape(quad);
+}
+
+BallInstance* BallRenderer::mapInstances(size_t n) {
+    if (n == 0) return nullptr;
+    return static_cast<BallInstance*>(instances.map(n * sizeof(BallInstance)));
+}
+
+void BallRenderer::drawInstances(size_t n) {
+    size_t offset = instances.unmap();
+
+    const Shape& shape = mode == BallRenderMode::Fan ? fan : quad;
+    glUseProgram(shape.program);
+    glBindVertexArray(shape.vao);
+
+    // De regio verschuift per frame, dus de attribuutpointer ook
+    glBindBuffer(GL_ARRAY_BUFFER, instances.buffer());
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(BallInstance), (void*)offset);
+    glVertexAttribIPointer(2, 1, GL_UNSIGNED_INT, sizeof(BallInstance), (void*)(offset + offsetof(BallInstance, id)));
+
+    glDrawArraysInstanced(shape.primitive, 0, shape.vertexCount, static_cast<GLsizei>(n));
+    instances.fence();
+}
+
+void BallRenderer::draw(const SimSnapshot& snapshot, float alpha) {
+    BallInstance* out = mapInstances(snapshot.count);
+    if (!out) return;
+    const BallInstance* from = snapshot.from.data();
+    const BallInstance* to = snapshot.to.data();
+    for (size_t i = 0; i < snapshot.count; ++i) {
+        out[i].x = from[i].x + (to[i].x - from[i].x) * alpha;
+        out[i].y = from[i].y + (to[i].y - from[i].y) * alpha;
+        out[i].id = to[i].id;
+    }
+    drawInstances(snapshot.count);
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <glad/glad.h>
+#include "SimulationThread.h"
+#include "StreamBuffer.h"
+
+enum class BallRenderMode {
+    Fan,  // driehoekswaaier van CIRCLE_SEGMENTS + 2 vertices per bal
+    Quad  // 4 vertices per bal, schijf en verloop berekend in de fragment shader
+};
+
+// Tekent alle ballen met een enkele instanced draw call. Per instance staan
+// de positie en het id van de bal in de buffer; de kleur volgt in de vertex
+// shader uit het id, zodat hij niet verspringt als de ballen herordend worden.
+class BallRenderer {
+public:
+    BallRenderer();
+
+    // Geeft de GL-objecten vrij; aanroepen zolang de context nog bestaat.
+    void destroy();
+
+    BallRenderer(const BallRenderer&) = delete;
+    BallRenderer& operator=(const BallRenderer&) = delete;
+
+    // Tekent de ballen op alpha tussen snapshot.from en snapshot.to.
+    void draw(const SimSnapshot& snapshot, float alpha);
+
+    void setMode(BallRenderMode m) { mode = m; }
+    BallRenderMode getMode() const { return mode; }
+    bool persistentInstances() const { return instances.persistent(); }
+
+private:
+    struct Shape {
+        GLuint program = 0;
+        GLuint vao = 0;
+        GLuint vbo = 0;
+        GLenum primitive = GL_TRIANGLE_FAN;
+        GLsizei vertexCount = 0;
+    };
+
+    void createShape(Shape& shape, const char* fragmentSource, const float* vertices, size_t floatCount, GLenum primitive);
+    void destroyShape(Shape& shape);
+    BallInstance* mapInstances(size_t n);
+    void drawInstances(size_t n);
+
+    Shape fan;
+    Shape quad;
+    BallRenderMode mode = BallRenderMode::Quad;
+
+    StreamBuffer instances; // BallInstance per bal
+};
+
+const char* ballRenderModeName(BallRenderMode mode);
@@ -0,0 +1,121 @@
+#include "BallStore.h"
+#include <cstring>
+
+static_assert(BALL_STORE_CHUNK % BALL_STORE_LANES == 0, "een chunk moet uit hele SIMD-vectoren bestaan");
+static_assert(BALL_STORE_CHUNK * sizeof(float) % VIRTUAL_ARRAY_COMMIT_BYTES == 0,
+    "een chunk moet uit hele commit-stappen bestaan");
+
+BallStore::BallStore(const BallStore& other) {
+    *this = other;
+}
+
+BallStore& BallStore::operator=(const BallStore& other) {
+    if (this == &other) return *this;
+    clear();
+    reserve(other.count);
+    if (other.count) {
+        std::memcpy(px.data(), other.px.data(), other.count * sizeof(float));
+        std::memcpy(py.data(), other.py.data(), other.count * sizeof(float));
+        std::memcpy(pvx.data(), other.pvx.data(), other.count * sizeof(float));
+        std::memcpy(pvy.data(), other.pvy.data(), other.count * sizeof(float));
+    }
+    count = other.count;
+    return *this;
+}
+
+void BallStore::reserve(size_t n) {
+    if (n <= cap) return;
+
+    // Hele chunks erbij committen; de arrays worden ter plekke langer en nieuwe
+    // pagina's zijn al nul. De kosten hangen af van het aantal nieuwe chunks,
+    // niet van het aantal ballen dat er al is.
+    size_t newCap = (n + BALL_STORE_CHUNK - 1) / BALL_STORE_CHUNK * BALL_STORE_CHUNK;
+    px.reserve(newCap);
+    py.reserve(newCap);
+    pvx.reserve(newCap);
+    pvy.reserve(newCap);
+    cap = newCap;
+}
+
+void BallStore::clear() {
+    // Opvulling moet nul blijven voor de SIMD-lussen; alles voorbij count is dat al
+    if (count) {
+        std::memset(px.data(), 0, count * sizeof(float));
+        std::memset(py.data(), 0, count * sizeof(float));
+        std::memset(pvx.data(), 0, count * sizeof(float));
+        std::memset(pvy.data(), 0, count * sizeof(float));
+    }
+    count = 0;
+}
+
+void BallStore::push(const Ball& ball) {
+    if (count == cap) reserve(count + 1);
+    px[count] = ball.x;
+    py[count] = ball.y;
+    pvx[count] = ball.vx;
+    pvy[count] = ball.vy;
+    ++count;
+}
+
+BallRange BallStore::append(size_t n) {
+    reserve(count + n);
+    BallRange range = { count, count + n };
+    count += n; // voorbij count staat alles al op nul
+    return range;
+}
+
+void BallStore::swap_remove(size_t i) {
+    size_t last = count - 1;
+    px[i] = px[last];
+    py[i] = py[last];
+    pvx[i] = pvx[last];
+    pvy[i] = pvy[last];
+    px[last] = py[last] = pvx[last] = pvy[last] = 0.0f;
+    --count;
+}
+
+void BallStore::permute(const uint32_t* order, BallStore& scratch) {
+    scratch.clear();
+    scratch.reserve(count);
+    for (size_t k = 0; k < count; ++k) {
+        size_t i = order[k];
+        scratch.px[k] = px[i];
+        scratch.py[k] = py[i];
+        scratch.pvx[k] = pvx[i];
+        scratch.pvy[k] = pvy[i];
+    }
+    scratch.count = count;
+
+    // Arrays omwisselen; de capaciteit van beide stores blijft bij zijn arrays
+    px.swap(scratch.px);
+    py.swap(scratch.py);
+    pvx.swap(scratch.pvx);
+    pvy.swap(scratch.pvy);
+    size_t c = cap; cap = scratch.cap; scratch.cap = c;
+}
+
+bool BallStore::adopt(const MappedFile& file, const uint64_t offsets[4], size_t n, size_t capacity) {
+    const size_t bytes = capacity * sizeof(float);
+    VirtualArray<float>* arrays[] = { &px, &py, &pvx, &pvy };
+    for (int k = 0; k < 4; ++k) {
+        if (!arrays[k]->adopt(file, offsets[k], bytes)) {
+            // Half overgenomen is niets waard; lege arrays maken de store leeg
+            for (VirtualArray<float>* a : arrays) {
+                VirtualArray<float> empty;
+                a->swap(empty);
+            }
+            count = cap = 0;
+            return false;
+        }
+    }
+    count = n;
+    cap = capacity;
+    return true;
+}
+
+void BallStore::detach() {
+    px.detach();
+    py.detach();
+    pvx.detach();
+    pvy.detach();
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "Ball.h"
+#include "VirtualArray.h"
+
+// Eenvoudige view op een aaneengesloten array (std::span is pas C++20).
+template <typename T>
+struct Span {
+    T* ptr = nullptr;
+    size_t count = 0;
+
+    T* data() const { return ptr; }
+    size_t size() const { return count; }
+    T* begin() const { return ptr; }
+    T* end() const { return ptr + count; }
+    T& operator[](size_t i) const { return ptr[i]; }
+};
+
+// Structure-of-arrays opslag voor de ballen: x, y, vx en vy staan elk in een
+// eigen 64-byte uitgelijnde array. De capaciteit is opgevuld tot een veelvoud
+// van BALL_STORE_LANES zodat SIMD-lussen hele vectoren mogen lezen; de
+// opvulling staat altijd op nul.
+// De arrays liggen in gereserveerde adresruimte (VirtualArray) en groeien per
+// chunk van BALL_STORE_CHUNK ballen: een nieuwe chunk wordt achter de vorige
+// gecommit, dus groeien kopieert de bestaande ballen nooit, kost nooit twee keer
+// het geheugen en pointers blijven geldig. Omdat de chunks aansluiten blijft
+// elke array een gewone Span voor de SIMD-lussen en de grid.
+constexpr size_t BALL_STORE_ALIGNMENT = 64;
+constexpr size_t BALL_STORE_LANES = BALL_STORE_ALIGNMENT / sizeof(float);
+constexpr size_t BALL_STORE_CHUNK = 16 * 1024;
+
+// Harde grens op het aantal ballen: elke array per bal (hier, in Simulation,
+// de buurlijst en de snapshots) is een VirtualArray en kan niet voorbij
+// VIRTUAL_ARRAY_MAX_ELEMENTS groeien, ongeveer een miljoen op 32-bit. Wie
+// spawnt moet daar zelf op letten; de simulaties stoppen met spawnen zodra
+// de grens bereikt is en tellen de wandhits die geen bal meer opleveren.
+constexpr size_t BALL_STORE_MAX_BALLS = VIRTUAL_ARRAY_MAX_ELEMENTS;
+
+// Half-open bereik [begin, end) van ball-indices.
+struct BallRange {
+    size_t begin;
+    size_t end;
+};
+
+class BallStore {
+public:
+    BallStore() = default;
+    BallStore(const BallStore& other);
+    BallStore& operator=(const BallStore& other);
+
+    size_t size() const { return count; }
+    size_t capacity() const { return cap; }
+    bool empty() const { return count == 0; }
+
+    // Aantal (deels) gevulde chunks en het bereik van chunk c, voor lussen die
+    // chunk voor chunk werken.
+    size_t chunkCount() const { return (count + BALL_STORE_CHUNK - 1) / BALL_STORE_CHUNK; }
+    BallRange chunk(size_t c) const {
+        size_t begin = c * BALL_STORE_CHUNK;
+        return { begin, begin + BALL_STORE_CHUNK < count ? begin + BALL_STORE_CHUNK : count };
+    }
+
+    void reserve(size_t n);
+    void clear();
+    void push(const Ball& ball);
+    // Zet n ballen achteraan op nul en geeft hun bereik, zodat ze daarna
+    // parallel gevuld kunnen worden.
+    BallRange append(size_t n);
+    void swap_remove(size_t i);
+
+    // Zet de ballen in een nieuwe volgorde: bal k wordt de oude bal order[k].
+    // scratch is een tweede store die daarna de oude volgorde bevat; zolang
+    // die blijft bestaan kost herhaald herordenen geen nieuw geheugen.
+    void permute(const uint32_t* order, BallStore& scratch);
+
+    // Neemt n ballen over uit een checkpoint zonder ze te lezen: x, y, vx en
+    // vy worden elk een view op capacity floats in file vanaf offsets[0..3]
+    // (zie VirtualArray::adopt). capacity is een veelvoud van
+    // BALL_STORE_CHUNK en alles voorbij n is in het bestand nul. Bij false is
+    // de store leeg.
+    bool adopt(const MappedFile& file, const uint64_t offsets[4], size_t n, size_t capacity);
+    bool isMapped() const { return px.isMapped() || py.isMapped() || pvx.isMapped() || pvy.isMapped(); }
+    void detach();
+
+    Ball get(size_t i) const { return { px[i], py[i], pvx[i], pvy[i] }; }
+    void set(size_t i, const Ball& b) { px[i] = b.x; py[i] = b.y; pvx[i] = b.vx; pvy[i] = b.vy; }
+
+    Span<float> x() { return { px.data(), count }; }
+    Span<float> y() { return { py.data(), count }; }
+    Span<float> vx() { return { pvx.data(), count }; }
+    Span<float> vy() { return { pvy.data(), count }; }
+    Span<const float> x() const { return { px.data(), count }; }
+    Span<const float> y() const { return { py.data(), count }; }
+    Span<const float> vx() const { return { pvx.data(), count }; }
+    Span<const float> vy() const { return { pvy.data(), count }; }
+
+private:
+    VirtualArray<float> px;
+    VirtualArray<float> py;
+    VirtualArray<float> pvx;
+    VirtualArray<float> pvy;
+    size_t count = 0;
+    size_t cap = 0;
+};
@@ -0,0 +1,298 @@
+#include "Benchmark.h"
+#include "BallOrder.h"
+#include "Globals.h"
+#include "Grid.h"
+#include "Simulation.h"
+#include "WallKernel.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <chrono>
+#include <random>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cstring>
+#endif
+
+typedef std::chrono::steady_clock Clock;
+
+static double millisecondsSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// Telt last-level cache misses van de aanroepende thread via perf_event_open.
+// Op andere platforms (of zonder rechten op perf) is er geen teller en wordt
+// alleen de tijd gemeten; gebruik daar VTune of uProf.
+class CacheMissCounter {
+public:
+    CacheMissCounter() {
+#ifdef __linux__
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = PERF_COUNT_HW_CACHE_MISSES;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+#endif
+    }
+    ~CacheMissCounter() {
+#ifdef __linux__
+        if (fd >= 0) close(fd);
+#endif
+    }
+    CacheMissCounter(const CacheMissCounter&) = delete;
+    CacheMissCounter& operator=(const CacheMissCounter&) = delete;
+
+    bool available() const { return fd >= 0; }
+
+    void start() {
+#ifdef __linux__
+        if (fd < 0) return;
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+    }
+
+    long long stop() {
+#ifdef __linux__
+        if (fd < 0) return -1;
+        ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        long long count = 0;
+        if (read(fd, &count, sizeof(count)) != static_cast<ssize_t>(sizeof(count))) return -1;
+        return count;
+#else
+        return -1;
+#endif
+    }
+
+private:
+    int fd = -1;
+};
+
+BallStore randomBalls(size_t n, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    BallStore balls;
+    balls.reserve(n);
+    const float r = CIRCLE_RADIUS - BALL_RADIUS;
+    while (balls.size() < n) {
+        float x = unit(rng) * r;
+        float y = unit(rng) * r;
+        if (x * x + y * y >= r * r) continue;
+        balls.push({ x, y, unit(rng) * INITIAL_SPEED, unit(rng) * INITIAL_SPEED });
+    }
+    return balls;
+}
+
+BallStore clusteredBalls(size_t n, uint32_t seed) {
+    const int clusters = 8;
+    const float spread = 4.0f * BALL_RADIUS;
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    std::normal_distribution<float> offset(0.0f, spread);
+    const float r = CIRCLE_RADIUS - BALL_RADIUS;
+    const float centreR = r - 2.0f * spread;
+
+    float cx[clusters];
+    float cy[clusters];
+    for (int c = 0; c < clusters;) {
+        cx[c] = unit(rng) * centreR;
+        cy[c] = unit(rng) * centreR;
+        if (cx[c] * cx[c] + cy[c] * cy[c] < centreR * centreR) ++c;
+    }
+
+    BallStore balls;
+    balls.reserve(n);
+    while (balls.size() < n) {
+        int c = static_cast<int>(balls.size() % clusters);
+        float x = cx[c] + offset(rng);
+        float y = cy[c] + offset(rng);
+        if (x * x + y * y >= r * r) continue;
+        balls.push({ x, y, unit(rng) * INITIAL_SPEED, unit(rng) * INITIAL_SPEED });
+    }
+    return balls;
+}
+
+BallStore originBalls(size_t n, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    BallStore balls;
+    balls.reserve(n);
+    for (size_t i = 0; i < n; ++i)
+        balls.push({ 0.0f, 0.0f, unit(rng) * INITIAL_SPEED, unit(rng) * INITIAL_SPEED });
+    return balls;
+}
+
+// Verschil ten opzichte van de scalaire waarde, relatief aan de grootte
+// ervan met scale als ondergrens.
+static float relativeError(float value, float reference, float scale) {
+    return std::fabs(value - reference) / (std::fabs(reference) + scale);
+}
+
+bool checkWallKernels(std::ostream& out) {
+    // rsqrt met een Newton-stap haalt ongeveer 1e-7; ruim daarboven. Een
+    // afwijking van 1% in WALL_PUSH geeft al 7e-6 in de posities.
+    const float positionTolerance = 1e-6f;
+    const float velocityTolerance = 1e-5f;
+    const size_t n = 10007; // een staart die geen hele vector is
+    const float steps[] = { 1.0f, 8.0f, 60.0f };
+    const size_t ranges[][2] = { { 0, n }, { 3 * BALL_STORE_LANES, 200 * BALL_STORE_LANES } };
+
+    // Tot 37 keer INITIAL_SPEED, zodat bij de grote stappen veel ballen de rand raken
+    BallStore input = randomBalls(n, 99);
+    for (size_t i = 0; i < n; ++i) {
+        input.vx()[i] *= 1.0f + static_cast<float>(i % 37);
+        input.vy()[i] *= 1.0f + static_cast<float>(i % 37);
+    }
+
+    std::vector<uint32_t> refHits(n);
+    std::vector<uint32_t> hits(n);
+    bool allMatch = true;
+    for (size_t k = 1; k < WALL_KERNEL_COUNT; ++k) {
+        const KernelVariant<WallKernelFn>& kernel = WALL_KERNELS[k];
+        if (!kernelIsaSupported(kernel.isa)) {
+            out << kernelIsaName(kernel.isa) << ": skipped, not supported by this CPU\n";
+            continue;
+        }
+
+        bool match = true;
+        size_t cases = 0;
+        size_t totalHits = 0;
+        float maxPosError = 0.0f;
+        float maxVelError = 0.0f;
+        for (float dt : steps) {
+            for (const size_t* range : ranges) {
+                BallStore ref = input;
+                BallStore test = input;
+                size_t refCount = integrateAndReflectScalar(ref, range[0], range[1], dt, refHits.data());
+                size_t count = kernel.fn(test, range[0], range[1], dt, hits.data());
+                ++cases;
+                totalHits += refCount;
+
+                if (count != refCount || !std::equal(hits.begin(), hits.begin() + count, refHits.begin())) {
+                    out << kernelIsaName(kernel.isa) << ": dt " << dt << ", balls [" << range[0] << ", " << range[1]
+                        << "): " << count << " hits, scalar " << refCount << "\n";
+                    match = false;
+                }
+                // Ook buiten het bereik, daar mag niets veranderd zijn
+                for (size_t i = 0; i < n; ++i) {
+                    maxPosError = std::max(maxPosError, relativeError(test.x()[i], ref.x()[i], CIRCLE_RADIUS));
+                    maxPosError = std::max(maxPosError, relativeError(test.y()[i], ref.y()[i], CIRCLE_RADIUS));
+                    // Een component kan na het kaatsen bijna nul zijn; dan telt de snelheid
+                    const float speed = std::sqrt(ref.vx()[i] * ref.vx()[i] + ref.vy()[i] * ref.vy()[i]) + 1e-9f;
+                    maxVelError = std::max(maxVelError, relativeError(test.vx()[i], ref.vx()[i], speed));
+                    maxVelError = std::max(maxVelError, relativeError(test.vy()[i], ref.vy()[i], speed));
+                }
+            }
+        }
+        // Ook NaN telt als afwijking
+        if (!(maxPosError <= positionTolerance) || !(maxVelError <= velocityTolerance)) match = false;
+
+        out << kernelIsaName(kernel.isa) << ": " << (match ? "ok" : "MISMATCH") << ", " << cases << " cases, "
+            << totalHits << " hits, max error position " << maxPosError << " (tolerance " << positionTolerance
+            << "), velocity " << maxVelError << " (tolerance " << velocityTolerance << ")\n";
+        allMatch = allMatch && match;
+    }
+    return allMatch;
+}
+
+void runBroadphaseBenchmark() {
+    const size_t counts[] = { 100, 1000, 5000, 20000 };
+
+    std::cout << "balls\tbrute_tests\tbrute_ms\tgrid_tests\tgrid_ms\n";
+    for (size_t n : counts) {
+        BallStore balls = randomBalls(n, 1234);
+
+        BallStore bruteBalls = balls;
+        Clock::time_point t0 = Clock::now();
+        CollisionStats brute = collideBallsBruteForce(bruteBalls);
+        double bruteMs = millisecondsSince(t0);
+
+        UniformGrid grid;
+        BallStore gridBalls = balls;
+        Clock::time_point t1 = Clock::now();
+        CollisionStats gridStats = collideBallsGrid(gridBalls, grid);
+        double gridMs = millisecondsSince(t1);
+
+        std::cout << n << '\t'
+            << brute.pairTests << '\t' << bruteMs << '\t'
+            << gridStats.pairTests << '\t' << gridMs << '\n';
+    }
+}
+
+void runThreadScalingBenchmark(unsigned maxThreads) {
+    const size_t ballCount = 20000;
+    const int steps = 10;
+
+    // Machten van twee onder maxThreads, dan maxThreads zelf (ook als dat oneven is)
+    std::vector<unsigned> threadCounts;
+    for (unsigned threads = 1; threads < maxThreads; threads *= 2)
+        threadCounts.push_back(threads);
+    if (maxThreads > 0) threadCounts.push_back(maxThreads);
+
+    std::cout << "threads\tballs_end\tms_per_step\tspeedup\n";
+    double baseline = 0.0;
+    for (unsigned threads : threadCounts) {
+        Simulation sim(threads, SIM_REFERENCE_HZ, 42);
+        sim.load(randomBalls(ballCount, 1234));
+
+        Clock::time_point start = Clock::now();
+        for (int s = 0; s < steps; ++s)
+            sim.step();
+        double msPerStep = millisecondsSince(start) / steps;
+        if (threads == 1) baseline = msPerStep;
+
+        std::cout << threads << '\t' << sim.balls().size() << '\t'
+            << msPerStep << '\t' << baseline / msPerStep << '\n';
+    }
+}
+
+void runReorderBenchmark() {
+    const size_t counts[] = { 100000, 200000, 400000 };
+    const int reps = 3;
+    CacheMissCounter misses;
+    if (!misses.available())
+        std::cout << "# geen hardware cache-teller beschikbaar, alleen tijden\n";
+
+    std::cout << "balls\torder\tlocality\tcollide_ms\tcache_misses\n";
+    for (size_t n : counts) {
+        // randomBalls levert de ballen in willekeurige volgorde door de arena,
+        // zoals een populatie die lang zonder herordenen gegroeid is
+        BallStore random = randomBalls(n, 1234);
+        BallStore morton = random;
+        BallStore scratch;
+        BallOrder order;
+        morton.permute(order.sort(morton), scratch);
+        const BallStore* variants[] = { &random, &morton };
+        const char* names[] = { "random", "morton" };
+
+        for (int v = 0; v < 2; ++v) {
+            float locality = order.locality(*variants[v]);
+            double bestMs = 0.0;
+            long long bestMisses = -1;
+            UniformGrid grid;
+            BallStore balls;
+            for (int r = 0; r < reps; ++r) {
+                balls = *variants[v];
+                misses.start();
+                Clock::time_point t0 = Clock::now();
+                collideBallsGrid(balls, grid);
+                double ms = millisecondsSince(t0);
+                long long m = misses.stop();
+                if (r == 0 || ms < bestMs) bestMs = ms;
+                if (r == 0 || m < bestMisses) bestMisses = m;
+            }
+            std::cout << n << '\t' << names[v] << '\t' << locality << '\t' << bestMs << '\t';
+            if (bestMisses >= 0) std::cout << bestMisses << '\n';
+            else std::cout << "n/a\n";
+        }
+    }
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include "BallStore.h"
+
+// n ballen uniform verdeeld binnen de arena, reproduceerbaar via seed.
+BallStore randomBalls(size_t n, uint32_t seed);
+
+// n ballen in een paar dichte groepjes (normaal verdeeld rond willekeurige
+// middelpunten in de arena), zoals na een lange reeks spawns en botsingen.
+BallStore clusteredBalls(size_t n, uint32_t seed);
+
+// n ballen allemaal op de oorsprong, met willekeurige snelheden: het slechtste
+// geval voor elke broadphase, en wat spawnen zonder plaatsen oplevert.
+BallStore originBalls(size_t n, uint32_t seed);
+
+// Pair tests en tijd van de grid-broadphase tegenover de O(n^2) loop.
+void runBroadphaseBenchmark();
+
+// Tijd per simulatiestap met 1 tot maxThreads threads.
+void runThreadScalingBenchmark(unsigned maxThreads);
+
+// Tijd en cache misses van de grid-broadphase met 100K+ ballen, in
+// willekeurige volgorde en na herordenen op Morton-volgorde.
+void runReorderBenchmark();
+
+// Draait elke wandkernel uit WALL_KERNELS die de CPU aankan (los van
+// BALLS_ISA) op dezelfde invoer als integrateAndReflectScalar. De hits moeten
+// gelijk zijn, posities en snelheden binnen een kleine relatieve marge (de
+// SIMD-versies gebruiken rsqrt en FMA). false als een kernel afwijkt.
+bool checkWallKernels(std::ostream& out);
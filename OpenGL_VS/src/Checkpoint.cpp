@@ -0,0 +1,143 @@
+#include "Checkpoint.h"
+#include "BallStore.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#endif
+
+static const char CHECKPOINT_MAGIC[8] = { 'B', 'A', 'L', 'L', 'C', 'K', 'P', 'T' };
+
+// Staat als 04 03 02 01 in het bestand op een little-endian machine.
+constexpr uint32_t CHECKPOINT_BYTE_ORDER = 0x01020304u;
+
+static_assert(sizeof(float) == 4 && sizeof(uint32_t) == 4, "de arrays hebben waarden van 4 bytes");
+static_assert(sizeof(CheckpointHeader) == 8 + 4 * 4 + 8 * 7 + 4 * 2 + 8 * (CHECKPOINT_ARRAY_COUNT + 2),
+    "CheckpointHeader mag geen opvulling hebben");
+static_assert(CHECKPOINT_ALIGNMENT % BALL_STORE_ALIGNMENT == 0, "arrays moeten als BallStore uitgelijnd zijn");
+static_assert(BALL_STORE_CHUNK * sizeof(float) % CHECKPOINT_ALIGNMENT == 0,
+    "een array van hele chunks eindigt op een uitlijngrens");
+
+// De arrays worden zonder omzetting overgenomen, dus alleen op little-endian.
+static bool littleEndian() {
+    const uint32_t probe = 1;
+    unsigned char first;
+    std::memcpy(&first, &probe, 1);
+    return first == 1;
+}
+
+static uint64_t alignUp(uint64_t offset) {
+    return (offset + CHECKPOINT_ALIGNMENT - 1) / CHECKPOINT_ALIGNMENT * CHECKPOINT_ALIGNMENT;
+}
+
+static bool replaceFile(const std::string& from, const std::string& to) {
+#ifdef _WIN32
+    return MoveFileExA(from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+    return std::rename(from.c_str(), to.c_str()) == 0;
+#endif
+}
+
+bool writeCheckpoint(const std::string& path, CheckpointHeader& header, const void* const* arrays,
+    const float* spawnVx, const float* spawnVy, std::string& error) {
+    if (!littleEndian()) {
+        error = "checkpoints are little-endian only";
+        return false;
+    }
+    std::memcpy(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic));
+    header.version = CHECKPOINT_VERSION;
+    header.headerBytes = sizeof(CheckpointHeader);
+    header.byteOrder = CHECKPOINT_BYTE_ORDER;
+    header.valueBytes = 4;
+    header.reserved = 0;
+    header.capacity = (header.ballCount + BALL_STORE_CHUNK - 1) / BALL_STORE_CHUNK * BALL_STORE_CHUNK;
+
+    const uint64_t arrayBytes = header.capacity * 4;
+    uint64_t offset = alignUp(sizeof(CheckpointHeader));
+    for (int k = 0; k < CHECKPOINT_ARRAY_COUNT; ++k) {
+        header.arrayOffset[k] = offset;
+        offset = alignUp(offset + arrayBytes);
+    }
+    header.spawnOffset = offset;
+    header.fileBytes = offset + 2 * header.pendingSpawns * sizeof(float);
+
+    const std::string tmpPath = path + ".tmp";
+    {
+        std::ofstream out(tmpPath.c_str(), std::ios::binary | std::ios::trunc);
+        if (!out) {
+            error = "cannot write " + tmpPath;
+            return false;
+        }
+        // Elk gat is korter dan de uitlijning
+        std::vector<char> zeros(CHECKPOINT_ALIGNMENT, 0);
+        const uint64_t usedBytes = header.ballCount * 4;
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(zeros.data(), static_cast<std::streamsize>(header.arrayOffset[0] - sizeof(header)));
+        for (int k = 0; k < CHECKPOINT_ARRAY_COUNT; ++k) {
+            out.write(static_cast<const char*>(arrays[k]), static_cast<std::streamsize>(usedBytes));
+            out.write(zeros.data(), static_cast<std::streamsize>(arrayBytes - usedBytes));
+        }
+        out.write(reinterpret_cast<const char*>(spawnVx), static_cast<std::streamsize>(header.pendingSpawns * sizeof(float)));
+        out.write(reinterpret_cast<const char*>(spawnVy), static_cast<std::streamsize>(header.pendingSpawns * sizeof(float)));
+        out.flush();
+        if (!out) {
+            error = "cannot write " + tmpPath;
+            out.close();
+            std::remove(tmpPath.c_str());
+            return false;
+        }
+    }
+    if (!replaceFile(tmpPath, path)) {
+        error = "cannot replace " + path;
+        std::remove(tmpPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool openCheckpoint(const std::string& path, MappedFile& file, CheckpointHeader& header, std::string& error) {
+    if (!littleEndian()) {
+        error = "checkpoints are little-endian only";
+        return false;
+    }
+    if (!file.open(path.c_str())) {
+        error = "cannot open " + path;
+        return false;
+    }
+    if (!file.read(0, &header, sizeof(header)) || std::memcmp(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic)) != 0) {
+        error = path + " is not a checkpoint";
+        return false;
+    }
+    if (header.version != CHECKPOINT_VERSION || header.headerBytes != sizeof(CheckpointHeader)) {
+        error = path + " has checkpoint version " + std::to_string(header.version) + ", expected " +
+            std::to_string(CHECKPOINT_VERSION);
+        return false;
+    }
+    if (header.byteOrder != CHECKPOINT_BYTE_ORDER || header.valueBytes != 4) {
+        error = path + " was written with a different byte order";
+        return false;
+    }
+
+    // Alles wat hierna gemapt of gelezen wordt moet kloppen, anders geeft een
+    // view voorbij het einde pas bij gebruik een crash
+    const uint64_t arrayBytes = header.capacity * 4;
+    bool valid = header.ballCount <= header.capacity && header.capacity % BALL_STORE_CHUNK == 0 &&
+        header.capacity <= VIRTUAL_ARRAY_MAX_ELEMENTS && header.fileBytes == file.size() &&
+        header.pendingSpawns <= file.size() && header.pendingSpawns <= VIRTUAL_ARRAY_MAX_ELEMENTS &&
+        header.ballCount <= UINT32_MAX;
+    for (int k = 0; valid && k < CHECKPOINT_ARRAY_COUNT; ++k) {
+        valid = header.arrayOffset[k] % CHECKPOINT_ALIGNMENT == 0 && header.arrayOffset[k] >= sizeof(header) &&
+            header.arrayOffset[k] + arrayBytes <= file.size();
+    }
+    valid = valid && header.spawnOffset + 2 * header.pendingSpawns * sizeof(float) <= file.size();
+    if (!valid) {
+        error = path + " is truncated or damaged";
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "VirtualArray.h"
+
+// Bestandsformaat voor de volledige toestand van een Simulation, zo ingedeeld
+// dat laden de ballen kan mappen in plaats van lezen en omzetten.
+//
+// Versie 1, alles little-endian:
+//   CheckpointHeader
+//   per array in CheckpointArray-volgorde: capacity waarden van 4 bytes op een
+//     veelvoud van CHECKPOINT_ALIGNMENT, voorbij ballCount opgevuld met nullen
+//   de spawnrij: pendingSpawns keer vx, dan pendingSpawns keer vy
+//
+// De arrays staan op de allocatiegranulariteit van Windows (ook een veelvoud
+// van elke paginagrootte), de enige eis voor een view op een bestand.
+constexpr uint32_t CHECKPOINT_VERSION = 1;
+constexpr size_t CHECKPOINT_ALIGNMENT = VIRTUAL_ARRAY_COMMIT_BYTES;
+
+enum CheckpointArray {
+    CHECKPOINT_X,
+    CHECKPOINT_Y,
+    CHECKPOINT_VX,
+    CHECKPOINT_VY,
+    CHECKPOINT_IDS,      // id per index
+    CHECKPOINT_ID_INDEX, // index per id
+    CHECKPOINT_ARRAY_COUNT
+};
+
+struct CheckpointHeader {
+    char magic[8];        // "BALLCKPT"
+    uint32_t version;
+    uint32_t headerBytes; // sizeof(CheckpointHeader) van de schrijver
+    uint32_t byteOrder;   // CHECKPOINT_BYTE_ORDER, zoals de schrijver het in het geheugen had
+    uint32_t valueBytes;  // 4: float en uint32_t
+    uint64_t ballCount;
+    uint64_t capacity;    // waarden per array, een veelvoud van BALL_STORE_CHUNK
+    uint64_t seed;        // de CounterRng; met steps de hele toestand van de RNG
+    uint64_t steps;
+    uint64_t lastReorderStep;
+    uint64_t reorders;
+    uint64_t pendingSpawns;
+    float sortedLocality;
+    uint32_t reserved;
+    uint64_t arrayOffset[CHECKPOINT_ARRAY_COUNT];
+    uint64_t spawnOffset;
+    uint64_t fileBytes;
+};
+
+// Schrijft header en de arrays naar path; vult zelf alles in behalve de
+// toestand van de simulatie (ballCount, seed tot en met sortedLocality).
+// arrays[k] heeft ballCount waarden voor CheckpointArray k. Eerst naar
+// path + ".tmp" en dan hernoemd, zodat een half geschreven bestand nooit een
+// goed checkpoint vervangt.
+bool writeCheckpoint(const std::string& path, CheckpointHeader& header, const void* const* arrays,
+    const float* spawnVx, const float* spawnVy, std::string& error);
+
+// Opent path en controleert de header: magic, versie, byte order en of alle
+// arrays uitgelijnd en binnen het bestand liggen. Daarna kan elke array met
+// VirtualArray::adopt overgenomen worden.
+bool openCheckpoint(const std::string& path, MappedFile& file, CheckpointHeader& header, std::string& error);
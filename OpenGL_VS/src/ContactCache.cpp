@@ -0,0 +1,169 @@
+#include "ContactCache.h"
+#include "Globals.h"
+#include <algorithm>
+#include <cmath>
+
+static uint64_t contactKey(uint32_t a, uint32_t b) {
+    return a < b ? (static_cast<uint64_t>(a) << 32) | b : (static_cast<uint64_t>(b) << 32) | a;
+}
+
+void ContactCache::StepContacts::resize(size_t cells, unsigned workers) {
+    if (workerUsed.size() != workers) {
+        workerContacts.reset(new VirtualArray<Contact>[workers]);
+        workerUsed.assign(workers, 0);
+    }
+    if (cellCount.size() != cells) {
+        cellWorker.assign(cells, 0);
+        cellBegin.assign(cells, 0);
+        cellCount.assign(cells, 0);
+    }
+    clear();
+}
+
+void ContactCache::StepContacts::clear() {
+    std::fill(workerUsed.begin(), workerUsed.end(), 0);
+    std::fill(cellCount.begin(), cellCount.end(), 0);
+}
+
+void ContactCache::beginStep(size_t cellCount, unsigned workers, const uint32_t* ids) {
+    ballIds = ids;
+    StepContacts& previous = steps[current];
+    if (previous.cellCount.size() != cellCount || previous.workerUsed.size() != workers) {
+        // Andere cellen of werkers: de vorige stap is niet terug te vinden
+        steps[0].resize(cellCount, workers);
+        steps[1].resize(cellCount, workers);
+        return;
+    }
+    // Alleen omwisselen; de arrays houden hun capaciteit
+    current ^= 1;
+    steps[current].clear();
+}
+
+void ContactCache::clear() {
+    steps[0].clear();
+    steps[1].clear();
+}
+
+size_t ContactCache::contactCount() const {
+    size_t count = 0;
+    for (uint32_t n : steps[current].cellCount) count += n;
+    return count;
+}
+
+bool ContactCache::add(const BallStore& balls, uint32_t cell, unsigned worker, uint32_t i, uint32_t j) {
+    StepContacts& now = steps[current];
+    size_t& used = now.workerUsed[worker];
+    VirtualArray<Contact>& list = now.workerContacts[worker];
+    if (used == list.capacity()) {
+        if (used == VIRTUAL_ARRAY_MAX_ELEMENTS) return false;
+        list.reserve(used + 1);
+    }
+
+    Span<const float> x = balls.x();
+    Span<const float> y = balls.y();
+    Span<const float> vx = balls.vx();
+    Span<const float> vy = balls.vy();
+
+    float dx = x[j] - x[i];
+    float dy = y[j] - y[i];
+    float dist = std::sqrt(dx * dx + dy * dy);
+    if (dist == 0.0f) return true; // geen normaal, net als resolveBallCollision
+
+    Contact c;
+    c.key = contactKey(ballIds[i], ballIds[j]);
+    c.i = i;
+    c.j = j;
+    c.nx = dx / dist;
+    c.ny = dy / dist;
+    c.overlap = 2 * BALL_RADIUS - dist;
+    float vn = (vx[j] - vx[i]) * c.nx + (vy[j] - vy[i]) * c.ny;
+
+    StepContacts& previous = steps[current ^ 1];
+    const Contact* oldBegin = previous.cell(cell);
+    const Contact* oldEnd = oldBegin + previous.cellCount[cell];
+    const Contact* it = std::lower_bound(oldBegin, oldEnd, c.key,
+        [](const Contact& a, uint64_t key) { return a.key < key; });
+    if (it != oldEnd && it->key == c.key) {
+        // Raakte de vorige stap ook al: rustend contact, alleen niet verder in elkaar
+        c.target = 0.0f;
+        c.impulse = warmStart && vn < 0.0f ? it->impulse : 0.0f;
+        c.warmNx = it->nx;
+        c.warmNy = it->ny;
+    }
+    else {
+        // Nieuwe botsing: elastisch, zoals resolveBallCollision
+        c.target = vn < 0.0f ? -vn : 0.0f;
+        c.impulse = 0.0f;
+        c.warmNx = c.nx;
+        c.warmNy = c.ny;
+    }
+    // Het eerste contact van de cel bepaalt waar de rest komt
+    if (now.cellCount[cell] == 0) {
+        now.cellWorker[cell] = worker;
+        now.cellBegin[cell] = used;
+    }
+    list[used++] = c;
+    ++now.cellCount[cell];
+    return true;
+}
+
+// Gelijke massa's: een impuls p langs n verandert de normaalsnelheid van j
+// ten opzichte van i met 2p.
+void ContactCache::solveCell(BallStore& balls, uint32_t cell, CollisionStats& stats) {
+    StepContacts& now = steps[current];
+    const size_t count = now.cellCount[cell];
+    if (count == 0) return;
+    Contact* contacts = now.cell(cell);
+
+    Span<float> x = balls.x();
+    Span<float> y = balls.y();
+    Span<float> vx = balls.vx();
+    Span<float> vy = balls.vy();
+
+    // Warm start langs de normaal waarmee de impuls vorige stap is opgebouwd
+    for (size_t k = 0; k < count; ++k) {
+        const Contact& c = contacts[k];
+        if (c.impulse <= 0.0f) continue;
+        vx[c.i] -= c.impulse * c.warmNx;
+        vy[c.i] -= c.impulse * c.warmNy;
+        vx[c.j] += c.impulse * c.warmNx;
+        vy[c.j] += c.impulse * c.warmNy;
+        ++stats.warmStarts;
+    }
+
+    // Gauss-Seidel over de contacten van de cel tot geen impuls meer verandert
+    int iterations = 0;
+    float maxDelta;
+    do {
+        maxDelta = 0.0f;
+        for (size_t k = 0; k < count; ++k) {
+            Contact& c = contacts[k];
+            float vn = (vx[c.j] - vx[c.i]) * c.nx + (vy[c.j] - vy[c.i]) * c.ny;
+            float impulse = c.impulse + 0.5f * (c.target - vn);
+            if (impulse < 0.0f) impulse = 0.0f;
+            float delta = impulse - c.impulse;
+            c.impulse = impulse;
+            vx[c.i] -= delta * c.nx;
+            vy[c.i] -= delta * c.ny;
+            vx[c.j] += delta * c.nx;
+            vy[c.j] += delta * c.ny;
+            maxDelta = std::max(maxDelta, std::fabs(delta));
+        }
+    } while (++iterations < CONTACT_MAX_ITERATIONS && maxDelta > CONTACT_TOLERANCE);
+    stats.contactIterations += iterations;
+
+    // Overlap alleen wegduwen waar de solver de ballen tegen elkaar hield,
+    // zoals resolveBallCollision alleen naderende ballen uit elkaar zet
+    for (size_t k = 0; k < count; ++k) {
+        const Contact& c = contacts[k];
+        if (c.impulse <= 0.0f || c.overlap <= 0.0f) continue;
+        float push = 0.5f * c.overlap;
+        x[c.i] -= push * c.nx;
+        y[c.i] -= push * c.ny;
+        x[c.j] += push * c.nx;
+        y[c.j] += push * c.ny;
+    }
+
+    // Gesorteerd voor het opzoeken in de volgende stap
+    std::sort(contacts, contacts + count, [](const Contact& a, const Contact& b) { return a.key < b.key; });
+}
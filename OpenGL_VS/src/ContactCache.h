@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "BallStore.h"
+#include "Grid.h"
+#include "VirtualArray.h"
+
+// Contacten die over meerdere stappen blijven bestaan, zoals in de volle
+// cluster rond de oorsprong. Elk contact is te vinden op het paar ball-ids
+// (Simulation::ballId) en houdt de normaal en de opgetelde impuls van de
+// vorige stap vast, zodat de solver daar mee kan beginnen (warm start) in
+// plaats van bij nul.
+//
+// Contacten staan per cel van de broadphase, bij de cel die eigenaar is van
+// het paar. Een cel wordt door precies een thread verwerkt, dus lezen en
+// schrijven gaat zonder locks en het resultaat hangt niet af van het aantal
+// threads. Elke stap bouwt een cel een nieuwe lijst op uit de paren die nu
+// raken; een contact dat niet meer raakt gaat niet mee naar de volgende stap.
+// Verouderde contacten verdwijnen zo per cel, zonder aparte opruimronde.
+// Wisselt het paar van eigenaar omdat een bal van cel verandert, dan begint
+// het als nieuw contact.
+//
+// Elke werker zet de contacten van zijn cellen achter elkaar in een eigen
+// VirtualArray; per cel staat waar ze beginnen en hoeveel het er zijn. Een
+// cel moet dus al zijn add()s en dan solveCell() op een werker doen, zoals
+// collideCell van de grid en de buurlijst. Groeien kost alleen address space,
+// dus een stap met evenveel ballen alloceert niets.
+class ContactCache {
+public:
+    // Aan het begin van elke stap: de contacten van deze stap worden de vorige.
+    // ids blijft geldig tot het eind van de stap. Alleen als cellCount of
+    // workers verandert wordt er gealloceerd.
+    void beginStep(size_t cellCount, unsigned workers, const uint32_t* ids);
+    void clear();
+
+    // Zonder warm start begint elk contact bij impuls nul; alleen voor het
+    // vergelijken van het aantal iteraties.
+    void setWarmStart(bool enabled) { warmStart = enabled; }
+    bool warmStarting() const { return warmStart; }
+
+    // Verzamelt een paar dat elkaar raakt, van de cel die eigenaar is; worker
+    // is die van de ThreadPool (0 zonder pool). false als de contacten van
+    // worker niet meer in een VirtualArray passen: dan lost de aanroeper het
+    // paar zelf op, zonder solver.
+    bool add(const BallStore& balls, uint32_t cell, unsigned worker, uint32_t i, uint32_t j);
+
+    // Lost alle verzamelde contacten van cell op: eerst de warm start, dan
+    // iteraties tot de impulsen niet meer veranderen, dan de overlap.
+    void solveCell(BallStore& balls, uint32_t cell, CollisionStats& stats);
+
+    size_t contactCount() const;
+
+private:
+    struct Contact {
+        uint64_t key;       // laagste id in de hoge helft
+        uint32_t i, j;      // ball-indices in deze stap
+        float nx, ny;       // van i naar j
+        float warmNx, warmNy; // normaal van de vorige stap
+        float target;       // gewenste normaalsnelheid van j ten opzichte van i
+        float impulse;      // opgeteld, nooit negatief
+        float overlap;
+    };
+
+    // De contacten van een stap; per cel na solveCell gesorteerd op key.
+    struct StepContacts {
+        std::unique_ptr<VirtualArray<Contact>[]> workerContacts;
+        std::vector<size_t> workerUsed;
+        std::vector<uint32_t> cellWorker;
+        std::vector<size_t> cellBegin;
+        std::vector<uint32_t> cellCount;
+
+        void resize(size_t cells, unsigned workers);
+        void clear();
+        Contact* cell(uint32_t c) { return workerContacts[cellWorker[c]].data() + cellBegin[c]; }
+    };
+
+    StepContacts steps[2];
+    int current = 0; // steps[current] is deze stap, de andere de vorige
+    const uint32_t* ballIds = nullptr;
+    bool warmStart = true;
+};
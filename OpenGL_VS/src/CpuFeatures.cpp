@@ -0,0 +1,71 @@
+#include "CpuFeatures.h"
+
+#if BALLS_X86
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+#endif
+
+#if BALLS_X86
+static void cpuid(int leaf, int subleaf, int regs[4]) {
+#if defined(_MSC_VER)
+    __cpuidex(regs, leaf, subleaf);
+#else
+    unsigned a, b, c, d;
+    __cpuid_count(leaf, subleaf, a, b, c, d);
+    regs[0] = static_cast<int>(a);
+    regs[1] = static_cast<int>(b);
+    regs[2] = static_cast<int>(c);
+    regs[3] = static_cast<int>(d);
+#endif
+}
+
+static uint64_t readXcr0() {
+#if defined(_MSC_VER)
+    return _xgetbv(0);
+#else
+    unsigned lo, hi;
+    __asm__ volatile("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+    return (static_cast<uint64_t>(hi) << 32) | lo;
+#endif
+}
+
+static CpuFeatures detectCpuFeatures() {
+    CpuFeatures f;
+    int regs[4];
+    cpuid(0, 0, regs);
+    int maxLeaf = regs[0];
+
+    cpuid(1, 0, regs);
+    f.sse2 = (regs[3] & (1 << 26)) != 0;
+    f.sse42 = (regs[2] & (1 << 20)) != 0;
+    bool osxsave = (regs[2] & (1 << 27)) != 0;
+    bool avx = (regs[2] & (1 << 28)) != 0;
+    bool fma = (regs[2] & (1 << 12)) != 0;
+
+    // Het OS moet de YMM-registers (en voor AVX-512 ook de ZMM- en
+    // maskregisters) bewaren bij een context switch
+    const uint64_t xcr0 = osxsave && avx ? readXcr0() : 0;
+    bool ymmEnabled = (xcr0 & 0x6) == 0x6;
+    bool zmmEnabled = (xcr0 & 0xE6) == 0xE6;
+    f.fma = ymmEnabled && fma;
+    if (maxLeaf >= 7 && ymmEnabled) {
+        cpuid(7, 0, regs);
+        f.avx2 = (regs[1] & (1 << 5)) != 0;
+        f.avx512f = zmmEnabled && (regs[1] & (1 << 16)) != 0;
+    }
+    return f;
+}
+#else
+static CpuFeatures detectCpuFeatures() {
+    return CpuFeatures();
+}
+#endif
+
+const CpuFeatures& cpuFeatures() {
+    static const CpuFeatures features = detectCpuFeatures();
+    return features;
+}
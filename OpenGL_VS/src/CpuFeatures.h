@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define BALLS_X86 1
+#else
+#define BALLS_X86 0
+#endif
+
+// MSVC mag intrinsics altijd gebruiken; GCC/Clang moeten per functie het doel-ISA krijgen.
+// TARGET_AVX2_NOFMA laat FMA weg zodat de compiler mul + add niet samenvoegt
+// en het resultaat bit voor bit gelijk blijft aan de scalaire code.
+#if defined(_MSC_VER) && !defined(__clang__)
+#define TARGET_SSE2
+#define TARGET_AVX2
+#define TARGET_AVX2_NOFMA
+#define TARGET_AVX512
+#else
+#define TARGET_SSE2 __attribute__((target("sse2")))
+#define TARGET_AVX2 __attribute__((target("avx2,fma")))
+#define TARGET_AVX2_NOFMA __attribute__((target("avx2")))
+#define TARGET_AVX512 __attribute__((target("avx512f,avx2,fma")))
+#endif
+
+struct CpuFeatures {
+    bool sse2 = false;
+    bool sse42 = false;
+    bool avx2 = false;
+    bool fma = false;     // los van AVX2: een hypervisor kan het ene tonen en het andere niet
+    bool avx512f = false;
+};
+
+// Wordt een keer bepaald met cpuid en daarna gecachet.
+const CpuFeatures& cpuFeatures();
+
+inline int countTrailingZeros(uint32_t v) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long index;
+    _BitScanForward(&index, v);
+    return static_cast<int>(index);
+#else
+    return __builtin_ctz(v);
+#endif
+}
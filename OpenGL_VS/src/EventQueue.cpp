@@ -0,0 +1,57 @@
+#include "EventQueue.h"
+
+void EventQueue::clear() {
+    heap.clear();
+    position.clear();
+    times.clear();
+}
+
+void EventQueue::set(uint32_t key, double time) {
+    if (key >= position.size()) {
+        position.resize(key + 1, NOT_QUEUED);
+        times.resize(key + 1, 0.0);
+    }
+
+    if (position[key] == NOT_QUEUED) {
+        times[key] = time;
+        heap.push_back(key);
+        position[key] = static_cast<uint32_t>(heap.size() - 1);
+        siftUp(heap.size() - 1);
+        return;
+    }
+
+    double old = times[key];
+    times[key] = time;
+    if (time < old) siftUp(position[key]);
+    else siftDown(position[key]);
+}
+
+void EventQueue::place(size_t pos, uint32_t key) {
+    heap[pos] = key;
+    position[key] = static_cast<uint32_t>(pos);
+}
+
+void EventQueue::siftUp(size_t pos) {
+    uint32_t key = heap[pos];
+    while (pos > 0) {
+        size_t parent = (pos - 1) / 2;
+        if (times[heap[parent]] <= times[key]) break;
+        place(pos, heap[parent]);
+        pos = parent;
+    }
+    place(pos, key);
+}
+
+void EventQueue::siftDown(size_t pos) {
+    uint32_t key = heap[pos];
+    const size_t n = heap.size();
+    for (;;) {
+        size_t child = 2 * pos + 1;
+        if (child >= n) break;
+        if (child + 1 < n && times[heap[child + 1]] < times[heap[child]]) ++child;
+        if (times[key] <= times[heap[child]]) break;
+        place(pos, heap[child]);
+        pos = child;
+    }
+    place(pos, key);
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Binaire min-heap op tijd met hoogstens een entry per sleutel (ball-index).
+// De tijd van een sleutel kan ter plekke verzet worden in O(log n), zodat een
+// bal die opnieuw voorspeld wordt zijn oude event niet als wees achterlaat.
+class EventQueue {
+public:
+    void clear();
+    bool empty() const { return heap.empty(); }
+    size_t size() const { return heap.size(); }
+
+    // Voegt key toe of verzet zijn tijd.
+    void set(uint32_t key, double time);
+
+    uint32_t top() const { return heap[0]; }
+    double topTime() const { return times[heap[0]]; }
+
+private:
+    static constexpr uint32_t NOT_QUEUED = 0xffffffffu;
+
+    void siftUp(size_t pos);
+    void siftDown(size_t pos);
+    void place(size_t pos, uint32_t key);
+
+    std::vector<uint32_t> heap;     // sleutels in heapvolgorde
+    std::vector<uint32_t> position; // positie per sleutel in heap
+    std::vector<double> times;      // tijd per sleutel
+};
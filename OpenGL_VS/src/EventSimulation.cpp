@@ -0,0 +1,277 @@
+#include "EventSimulation.h"
+#include "Globals.h"
+#include "Profiler.h"
+#include <cmath>
+#include <limits>
+
+// Cellen iets groter dan een baldiameter: twee ballen die elkaar raken liggen
+// dan altijd in naburige cellen, ook met afrondingsfouten op de celgrens.
+constexpr double EVENT_CELL_SIZE = 2.0 * BALL_RADIUS * 1.01;
+constexpr int EVENT_GRID_DIM = static_cast<int>(2.0 * CIRCLE_RADIUS / EVENT_CELL_SIZE) + 2;
+constexpr double EVENT_GRID_ORIGIN = -CIRCLE_RADIUS;
+
+constexpr double WALL_DIST = CIRCLE_RADIUS - BALL_RADIUS;
+constexpr double CONTACT_DIST = 2.0 * BALL_RADIUS;
+constexpr double NEVER = std::numeric_limits<double>::infinity();
+constexpr uint32_t NO_BALL = 0xffffffffu;
+
+static int eventCellCoord(double p) {
+    int c = static_cast<int>(std::floor((p - EVENT_GRID_ORIGIN) / EVENT_CELL_SIZE));
+    if (c < 0) return 0;
+    if (c >= EVENT_GRID_DIM) return EVENT_GRID_DIM - 1;
+    return c;
+}
+
+// Tijd tot het verlaten van [lo, lo + EVENT_CELL_SIZE) langs een as; aan de
+// rand van de grid is er geen volgende cel.
+static double cellExitTime(double p, double v, int c, int& step) {
+    double lo = EVENT_GRID_ORIGIN + c * EVENT_CELL_SIZE;
+    if (v > 0.0 && c < EVENT_GRID_DIM - 1) {
+        step = 1;
+        double dt = (lo + EVENT_CELL_SIZE - p) / v;
+        return dt > 0.0 ? dt : 0.0;
+    }
+    if (v < 0.0 && c > 0) {
+        step = -1;
+        double dt = (lo - p) / v;
+        return dt > 0.0 ? dt : 0.0;
+    }
+    step = 0;
+    return NEVER;
+}
+
+EventSimulation::EventSimulation(uint64_t seed)
+    : rngSeed(seed), rng(seed) {
+    reset();
+}
+
+void EventSimulation::reset() {
+    load(BallStore());
+    addBall(0.0, 0.0, INITIAL_SPEED, INITIAL_SPEED);
+    syncStore();
+}
+
+void EventSimulation::load(const BallStore& balls) {
+    now = 0.0;
+    spawns = 0;
+    stats = EventStats();
+    x.clear();
+    y.clear();
+    vx.clear();
+    vy.clear();
+    t.clear();
+    changes.clear();
+    events.clear();
+    cellOf.clear();
+    nextInCell.clear();
+    prevInCell.clear();
+    cellHead.assign(EVENT_GRID_DIM * EVENT_GRID_DIM, NO_BALL);
+    queue.clear();
+
+    // Elke bal voorspelt tegen de ballen die er al zijn; zo wordt elk paar
+    // precies een keer bekeken.
+    for (size_t i = 0; i < balls.size(); ++i) {
+        Ball b = balls.get(i);
+        addBall(b.x, b.y, b.vx, b.vy);
+    }
+    store.clear();
+    syncStore();
+}
+
+void EventSimulation::addBall(double px, double py, double pvx, double pvy) {
+    uint32_t i = static_cast<uint32_t>(x.size());
+    x.push_back(px);
+    y.push_back(py);
+    vx.push_back(pvx);
+    vy.push_back(pvy);
+    t.push_back(now);
+    changes.push_back(0);
+    events.push_back({ NEVER, 0, 0, EVENT_NONE });
+    cellOf.push_back(0);
+    nextInCell.push_back(NO_BALL);
+    prevInCell.push_back(NO_BALL);
+    linkCell(i, eventCellCoord(py) * EVENT_GRID_DIM + eventCellCoord(px));
+    predict(i);
+}
+
+void EventSimulation::linkCell(uint32_t i, uint32_t cell) {
+    cellOf[i] = cell;
+    prevInCell[i] = NO_BALL;
+    nextInCell[i] = cellHead[cell];
+    if (cellHead[cell] != NO_BALL) prevInCell[cellHead[cell]] = i;
+    cellHead[cell] = i;
+}
+
+void EventSimulation::unlinkCell(uint32_t i) {
+    if (prevInCell[i] != NO_BALL) nextInCell[prevInCell[i]] = nextInCell[i];
+    else cellHead[cellOf[i]] = nextInCell[i];
+    if (nextInCell[i] != NO_BALL) prevInCell[nextInCell[i]] = prevInCell[i];
+}
+
+void EventSimulation::moveTo(uint32_t i, double time) {
+    double dt = time - t[i];
+    x[i] += vx[i] * dt;
+    y[i] += vy[i] * dt;
+    t[i] = time;
+}
+
+// Zoekt het eerste event van bal i vanaf now; bal i moet al op now staan.
+void EventSimulation::predict(uint32_t i) {
+    Event e = { NEVER, 0, 0, EVENT_NONE };
+
+    // Rand: |p + v dt| = WALL_DIST, de grootste wortel
+    double a = vx[i] * vx[i] + vy[i] * vy[i];
+    if (a > 0.0) {
+        double b = x[i] * vx[i] + y[i] * vy[i];
+        double c = x[i] * x[i] + y[i] * y[i] - WALL_DIST * WALL_DIST;
+        double dt;
+        if (c >= 0.0 && b > 0.0) {
+            dt = 0.0; // al op of over de rand en op weg naar buiten
+        }
+        else {
+            double disc = b * b - a * c;
+            dt = (-b + std::sqrt(disc > 0.0 ? disc : 0.0)) / a;
+            if (dt < 0.0) dt = 0.0;
+        }
+        e = { now + dt, 0, 0, EVENT_WALL };
+    }
+
+    // Gridcel verlaten
+    const int cx = static_cast<int>(cellOf[i] % EVENT_GRID_DIM);
+    const int cy = static_cast<int>(cellOf[i] / EVENT_GRID_DIM);
+    int stepX, stepY;
+    double tx = cellExitTime(x[i], vx[i], cx, stepX);
+    double ty = cellExitTime(y[i], vy[i], cy, stepY);
+    if (tx < ty && now + tx < e.time)
+        e = { now + tx, static_cast<uint32_t>(cy * EVENT_GRID_DIM + cx + stepX), 0, EVENT_CELL };
+    else if (ty <= tx && now + ty < e.time)
+        e = { now + ty, static_cast<uint32_t>((cy + stepY) * EVENT_GRID_DIM + cx), 0, EVENT_CELL };
+
+    // Ballen in de 3x3 naburige cellen: |dr + dv dt| = CONTACT_DIST, kleinste wortel
+    for (int ny = cy - 1; ny <= cy + 1; ++ny) {
+        if (ny < 0 || ny >= EVENT_GRID_DIM) continue;
+        for (int nx = cx - 1; nx <= cx + 1; ++nx) {
+            if (nx < 0 || nx >= EVENT_GRID_DIM) continue;
+            for (uint32_t j = cellHead[ny * EVENT_GRID_DIM + nx]; j != NO_BALL; j = nextInCell[j]) {
+                if (j == i) continue;
+                ++stats.pairTests;
+                double lag = now - t[j];
+                double dx = x[j] + vx[j] * lag - x[i];
+                double dy = y[j] + vy[j] * lag - y[i];
+                double dvx = vx[j] - vx[i];
+                double dvy = vy[j] - vy[i];
+                double b = dx * dvx + dy * dvy;
+                if (b >= 0.0) continue; // gaan uit elkaar
+
+                // Ballen die al overlappen (bijvoorbeeld net gespawnd in de
+                // oorsprong) gaan door elkaar heen tot ze los zijn; direct botsen
+                // kan in een cluster eindeloos heen en weer gaan zonder dat de
+                // tijd vooruit komt.
+                double c = dx * dx + dy * dy - CONTACT_DIST * CONTACT_DIST;
+                if (c < 0.0) continue;
+                double av = dvx * dvx + dvy * dvy;
+                double disc = b * b - av * c;
+                if (disc < 0.0) continue;
+                double dt = (-b - std::sqrt(disc)) / av;
+                if (now + dt < e.time)
+                    e = { now + dt, j, changes[j], EVENT_BALL };
+            }
+        }
+    }
+
+    events[i] = e;
+    queue.set(i, e.time);
+}
+
+void EventSimulation::process(uint32_t i) {
+    const Event e = events[i];
+    if (e.time > now) now = e.time;
+    ++stats.events;
+
+    switch (e.type) {
+    case EVENT_WALL: {
+        moveTo(i, now);
+        double dist = std::sqrt(x[i] * x[i] + y[i] * y[i]);
+        double nx = x[i] / dist;
+        double ny = y[i] / dist;
+        double dot = vx[i] * nx + vy[i] * ny;
+        vx[i] -= 2 * dot * nx;
+        vy[i] -= 2 * dot * ny;
+        ++changes[i];
+        ++stats.wallHits;
+        predict(i);
+
+        // Nieuwe bal in de oorsprong, zoals bij de vaste stap; balls() moet
+        // nog in een BallStore passen
+        if (x.size() >= BALL_STORE_MAX_BALLS) {
+            ++stats.spawnsDropped;
+            break;
+        }
+        float spawnVx, spawnVy;
+        generateDirections(rng, spawns++, 1, INITIAL_SPEED, &spawnVx, &spawnVy);
+        addBall(0.0, 0.0, spawnVx, spawnVy);
+        break;
+    }
+    case EVENT_CELL:
+        moveTo(i, now);
+        unlinkCell(i);
+        linkCell(i, e.partner);
+        ++stats.cellCrossings;
+        predict(i);
+        break;
+    case EVENT_BALL: {
+        const uint32_t j = e.partner;
+        moveTo(i, now);
+        if (changes[j] != e.partnerChanges) {
+            // j is van baan veranderd sinds deze voorspelling
+            ++stats.staleEvents;
+            predict(i);
+            break;
+        }
+        moveTo(j, now);
+
+        // Gelijke massa's: de normaalcomponenten van de snelheden wisselen om
+        double dx = x[j] - x[i];
+        double dy = y[j] - y[i];
+        double dist = std::sqrt(dx * dx + dy * dy);
+        if (dist > 0.0) {
+            double nx = dx / dist;
+            double ny = dy / dist;
+            double p = (vx[j] - vx[i]) * nx + (vy[j] - vy[i]) * ny;
+            vx[i] += p * nx;
+            vy[i] += p * ny;
+            vx[j] -= p * nx;
+            vy[j] -= p * ny;
+            ++changes[i];
+            ++changes[j];
+            ++stats.collisions;
+        }
+        predict(i);
+        predict(j);
+        break;
+    }
+    case EVENT_NONE:
+        break;
+    }
+}
+
+void EventSimulation::advance(double steps) {
+    PROFILE_SCOPE("events");
+    const double target = now + steps;
+    while (!queue.empty() && queue.topTime() <= target)
+        process(queue.top());
+    now = target;
+    syncStore();
+}
+
+void EventSimulation::syncStore() {
+    const size_t n = x.size();
+    store.reserve(n);
+    while (store.size() < n)
+        store.push({ 0.0f, 0.0f, 0.0f, 0.0f });
+    for (size_t i = 0; i < n; ++i) {
+        double lag = now - t[i];
+        store.set(i, { static_cast<float>(x[i] + vx[i] * lag), static_cast<float>(y[i] + vy[i] * lag),
+            static_cast<float>(vx[i]), static_cast<float>(vy[i]) });
+    }
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "BallStore.h"
+#include "EventQueue.h"
+#include "Random.h"
+
+struct EventStats {
+    uint64_t events = 0;        // verwerkte events, inclusief verouderde
+    uint64_t wallHits = 0;
+    uint64_t collisions = 0;
+    uint64_t cellCrossings = 0;
+    uint64_t staleEvents = 0;   // partner is sinds de voorspelling veranderd
+    uint64_t pairTests = 0;     // voorspelde botsingstijden tussen twee ballen
+    uint64_t spawnsDropped = 0; // wandhits zonder nieuwe bal: BALL_STORE_MAX_BALLS bereikt
+};
+
+// Event-driven variant van Simulation: in plaats van vaste stappen wordt per
+// bal het exacte tijdstip van zijn eerstvolgende event voorspeld (rand, bal of
+// het verlaten van zijn gridcel) en springt de simulatie van event naar event.
+// Tussen events beweegt een bal rechtlijnig, dus er wordt alleen gerekend als
+// er iets gebeurt en het resultaat hangt niet af van een stapgrootte.
+//
+// Tijd is in stappen van SIM_REFERENCE_HZ: een bal legt per tijdseenheid zijn
+// snelheid af, net als een stap van Simulation. Een wandhit kaatst exact op de
+// rand (zonder WALL_PUSH) en spawnt een bal in de oorsprong; richtingen komen
+// uit dezelfde CounterRng, met het spawnnummer als counter.
+class EventSimulation {
+public:
+    explicit EventSimulation(uint64_t seed = 1);
+
+    void reset();
+    // Begint opnieuw op tijd 0 met de gegeven ballen.
+    void load(const BallStore& balls);
+
+    // Verwerkt alle events tot now + steps en zet de posities in balls() op
+    // dat tijdstip.
+    void advance(double steps);
+
+    const BallStore& balls() const { return store; }
+    const EventStats& totals() const { return stats; }
+    double time() const { return now; }
+    uint64_t seed() const { return rngSeed; }
+
+private:
+    enum EventType : uint8_t { EVENT_NONE, EVENT_WALL, EVENT_CELL, EVENT_BALL };
+
+    struct Event {
+        double time;
+        uint32_t partner;         // bal bij EVENT_BALL, nieuwe cel bij EVENT_CELL
+        uint32_t partnerChanges;  // changes[partner] op het moment van voorspellen
+        EventType type;
+    };
+
+    void addBall(double px, double py, double pvx, double pvy);
+    void moveTo(uint32_t i, double t);
+    void predict(uint32_t i);
+    void process(uint32_t i);
+    void linkCell(uint32_t i, uint32_t cell);
+    void unlinkCell(uint32_t i);
+    void syncStore();
+
+    uint64_t rngSeed;
+    CounterRng rng;
+    uint64_t spawns = 0;
+    double now = 0.0;
+    EventStats stats;
+
+    // Toestand per bal op zijn eigen tijdstip t
+    std::vector<double> x, y, vx, vy, t;
+    std::vector<uint32_t> changes; // telt snelheidswijzigingen, maakt oude voorspellingen ongeldig
+    std::vector<Event> events;
+
+    // Cellijst: dubbel gelinkte lijst van ballen per cel
+    std::vector<uint32_t> cellHead;
+    std::vector<uint32_t> cellOf, nextInCell, prevInCell;
+
+    EventQueue queue;
+    BallStore store;
+};
@@ -0,0 +1,23 @@
+#include "FixedTimestep.h"
+#include <cmath>
+
+FixedTimestep::FixedTimestep(double stepHz, int maxSteps)
+    : dt(1.0 / stepHz), maxSteps(maxSteps) {
+}
+
+int FixedTimestep::advance(double frameSeconds) {
+    if (frameSeconds < 0.0) frameSeconds = 0.0;
+    accumulator += frameSeconds;
+
+    int steps = 0;
+    while (accumulator >= dt && steps < maxSteps) {
+        accumulator -= dt;
+        ++steps;
+    }
+
+    // Achterstand die niet in maxSteps past laten vallen, anders kost de
+    // volgende frame nog meer werk (spiral of death).
+    if (accumulator >= dt)
+        accumulator = std::fmod(accumulator, dt);
+    return steps;
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+// Accumulator voor een vaste simulatiestap. Elke frame levert de verstreken
+// tijd aan en krijgt terug hoeveel stappen (0..maxSteps) er gedaan moeten
+// worden; alpha() geeft aan hoe ver de frame tussen de laatste twee
+// simulatietoestanden ligt.
+class FixedTimestep {
+public:
+    FixedTimestep(double stepHz, int maxSteps);
+
+    int advance(double frameSeconds);
+
+    double stepSeconds() const { return dt; }
+    float alpha() const { return static_cast<float>(accumulator / dt); }
+
+private:
+    double dt;
+    double accumulator = 0.0;
+    int maxSteps;
+};
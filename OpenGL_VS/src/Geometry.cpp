@@ -0,0 +1,15 @@
+#include "Geometry.h"
+#include "Globals.h"
+#include <cmath>
+
+std::vector<float> generateCircleVertices(float radius, int segments) {
+    std::vector<float> vertices;
+    vertices.push_back(0.0f);
+    vertices.push_back(0.0f);
+    for (int i = 0; i <= segments; ++i) {
+        float angle = 2.0f * M_PI * i / segments;
+        vertices.push_back(radius * cos(angle));
+        vertices.push_back(radius * sin(angle));
+    }
+    return vertices;
+}
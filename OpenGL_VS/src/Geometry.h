@@ -0,0 +1,8 @@
+#pragma once
+
+#include <vector>
+
+// Driehoekswaaier rond de oorsprong: eerst het midden, dan segments + 1
+// punten op de rand (het laatste valt samen met het eerste). Zonder GL, zodat
+// ook de benchmarks het kunnen gebruiken.
+std::vector<float> generateCircleVertices(float radius, int segments);
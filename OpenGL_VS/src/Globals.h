@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstddef>
+
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
 #endif
@@ -11,6 +13,44 @@ constexpr float BALL_RADIUS = CIRCLE_RADIUS / 40.0f;
 constexpr int CIRCLE_SEGMENTS = 100;
 constexpr float INITIAL_SPEED = 0.0004f;
 
+// Snelheden zijn in eenheden per referentiestap. De simulatie loopt met een
+// vaste stap van 1 / simHz seconden, los van de framerate van het scherm.
+constexpr double SIM_REFERENCE_HZ = 60.0;
+constexpr double DEFAULT_SIM_HZ = 60.0;
+constexpr int MAX_STEPS_PER_FRAME = 8;
+
+// Uniform grid voor de broadphase: een cel is zo groot als een balldiameter,
+// dus botsende ballen liggen altijd in dezelfde of een aangrenzende cel.
+constexpr float GRID_CELL_SIZE = 2.0f * BALL_RADIUS;
+constexpr int GRID_DIM = static_cast<int>(2.0f * CIRCLE_RADIUS / GRID_CELL_SIZE) + 2;
+
+// Verlet-buurlijst: paren binnen een diameter plus skin. De lijst blijft
+// geldig tot een bal skin / 2 verschoven is, gemeten ongeveer 7,5 stappen.
+constexpr float NEIGHBOUR_SKIN = 0.5f * BALL_RADIUS;
+constexpr float NEIGHBOUR_CUTOFF = 2.0f * BALL_RADIUS + NEIGHBOUR_SKIN;
+constexpr int NEIGHBOUR_GRID_DIM = static_cast<int>(2.0f * CIRCLE_RADIUS / NEIGHBOUR_CUTOFF) + 2;
+
+// Herordenen op Morton-volgorde van de gridcel: elke REORDER_CHECK_STEPS
+// stappen wordt gemeten hoeveel opeenvolgende ballen nog buren zijn. Zakt dat
+// onder REORDER_MIN_LOCALITY keer de waarde direct na het sorteren, of is het
+// REORDER_MAX_STEPS stappen geleden, dan worden de arrays opnieuw gesorteerd.
+constexpr int REORDER_CHECK_STEPS = 64;
+constexpr int REORDER_MAX_STEPS = 1024;
+constexpr float REORDER_MIN_LOCALITY = 0.8f;
+constexpr size_t REORDER_MIN_BALLS = 4096; // kleiner past toch in de cache
+
+// Contactsolver: iteraties per cel tot geen impuls meer dan CONTACT_TOLERANCE
+// verandert, met hooguit CONTACT_MAX_ITERATIONS rondes.
+constexpr int CONTACT_MAX_ITERATIONS = 8;
+constexpr float CONTACT_TOLERANCE = 1e-3f * INITIAL_SPEED;
+
+// Spawnen: een nieuwe bal zoekt langs een spiraal rond de oorsprong de eerste
+// plek waar hij niets overlapt, tot SPAWN_SEARCH_RADIUS. Zit alles vol, dan
+// wacht hij op een volgende stap. Kandidaten liggen ongeveer
+// 1.8 * SPAWN_SPIRAL_STEP uit elkaar.
+constexpr float SPAWN_SEARCH_RADIUS = 8.0f * BALL_RADIUS;
+constexpr float SPAWN_SPIRAL_STEP = 0.5f * BALL_RADIUS;
+
 //extern bool paused;
 
 //bool paused = false;
@@ -0,0 +1,174 @@
+#include "Grid.h"
+#include "ContactCache.h"
+#include "ThreadPool.h"
+#include "Physics.h"
+#include "Profiler.h"
+#include <cmath>
+
+int gridCellCoord(float p) {
+    int c = static_cast<int>((p + CIRCLE_RADIUS) / GRID_CELL_SIZE);
+    if (c < 0) return 0;
+    if (c >= GRID_DIM) return GRID_DIM - 1;
+    return c;
+}
+
+UniformGrid::UniformGrid() {
+    for (int cy = 0; cy < GRID_DIM; ++cy)
+        for (int cx = 0; cx < GRID_DIM; ++cx)
+            colorCells[(cy % 3) * 3 + cx % 3].push_back(cy * GRID_DIM + cx);
+}
+
+void UniformGrid::build(const BallStore& balls, ThreadPool* pool) {
+    PROFILE_SCOPE("broadphase");
+    const size_t n = balls.size();
+    cellStart.assign(GRID_CELL_COUNT + 1, 0);
+    sortedBalls.reserve(n);
+    ballCell.reserve(n);
+
+    Span<const float> x = balls.x();
+    Span<const float> y = balls.y();
+
+    if (!pool || pool->threadCount() == 1 || n < 4096) {
+        // Tellen per cel
+        for (size_t i = 0; i < n; ++i) {
+            uint32_t cell = gridCellCoord(y[i]) * GRID_DIM + gridCellCoord(x[i]);
+            ballCell[i] = cell;
+            ++cellStart[cell + 1];
+        }
+
+        // Prefix sum geeft de startpositie van elke cel
+        for (size_t c = 0; c < GRID_CELL_COUNT; ++c)
+            cellStart[c + 1] += cellStart[c];
+
+        // Verspreiden; cellStart[c] schuift op en eindigt op het begin van cel c + 1
+        for (size_t i = 0; i < n; ++i)
+            sortedBalls[cellStart[ballCell[i]]++] = static_cast<uint32_t>(i);
+
+        // Offsets weer terugzetten naar het begin van elke cel
+        for (size_t c = GRID_CELL_COUNT; c > 0; --c)
+            cellStart[c] = cellStart[c - 1];
+        cellStart[0] = 0;
+        return;
+    }
+
+    // Parallelle counting sort: elk stuk telt in een eigen histogram, een
+    // prefix sum over (cel, stuk) geeft elk stuk zijn eigen schrijfposities.
+    const size_t chunkCount = pool->threadCount();
+    const size_t grain = (n + chunkCount - 1) / chunkCount;
+    chunkCounts.assign(chunkCount * GRID_CELL_COUNT, 0);
+
+    pool->parallelFor(n, grain, [&](size_t begin, size_t end, unsigned) {
+        uint32_t* counts = &chunkCounts[(begin / grain) * GRID_CELL_COUNT];
+        for (size_t i = begin; i < end; ++i) {
+            uint32_t cell = gridCellCoord(y[i]) * GRID_DIM + gridCellCoord(x[i]);
+            ballCell[i] = cell;
+            ++counts[cell];
+        }
+    });
+
+    uint32_t offset = 0;
+    for (size_t c = 0; c < GRID_CELL_COUNT; ++c) {
+        cellStart[c] = offset;
+        for (size_t k = 0; k < chunkCount; ++k) {
+            uint32_t count = chunkCounts[k * GRID_CELL_COUNT + c];
+            chunkCounts[k * GRID_CELL_COUNT + c] = offset;
+            offset += count;
+        }
+    }
+    cellStart[GRID_CELL_COUNT] = offset;
+
+    pool->parallelFor(n, grain, [&](size_t begin, size_t end, unsigned) {
+        uint32_t* next = &chunkCounts[(begin / grain) * GRID_CELL_COUNT];
+        for (size_t i = begin; i < end; ++i)
+            sortedBalls[next[ballCell[i]]++] = static_cast<uint32_t>(i);
+    });
+}
+
+// Verwerkt alle paren waarvan de eerste bal in cell ligt. Een paar over twee
+// cellen hoort bij de laagste cel, binnen een cel bij de laagste index.
+static void collideCell(BallStore& balls, const UniformGrid& grid, uint32_t cell, unsigned worker,
+    CollisionStats& stats, ContactCache* contacts) {
+    Span<float> x = balls.x();
+    Span<float> y = balls.y();
+    int cx = static_cast<int>(cell % GRID_DIM);
+    int cy = static_cast<int>(cell / GRID_DIM);
+
+    for (uint32_t a = grid.cellStart[cell]; a < grid.cellStart[cell + 1]; ++a) {
+        uint32_t i = grid.sortedBalls[a];
+
+        for (int ny = cy - 1; ny <= cy + 1; ++ny) {
+            if (ny < 0 || ny >= GRID_DIM) continue;
+            for (int nx = cx - 1; nx <= cx + 1; ++nx) {
+                if (nx < 0 || nx >= GRID_DIM) continue;
+
+                uint32_t other = ny * GRID_DIM + nx;
+                if (other < cell) continue;
+                uint32_t first = other == cell ? a + 1 : grid.cellStart[other];
+
+                for (uint32_t k = first; k < grid.cellStart[other + 1]; ++k) {
+                    uint32_t j = grid.sortedBalls[k];
+
+                    ++stats.pairTests;
+                    float dx = x[j] - x[i];
+                    float dy = y[j] - y[i];
+                    if (dx * dx + dy * dy < 4 * BALL_RADIUS * BALL_RADIUS) {
+                        if (!contacts || !contacts->add(balls, cell, worker, i, j))
+                            resolveBallCollision(balls, i, j);
+                        ++stats.collisions;
+                    }
+                }
+            }
+        }
+    }
+    if (contacts) contacts->solveCell(balls, cell, stats);
+}
+
+CollisionStats collideBallsGrid(BallStore& balls, UniformGrid& grid, ThreadPool* pool, ContactCache* contacts) {
+    grid.build(balls, pool);
+    PROFILE_SCOPE("narrowphase");
+
+    if (!pool || pool->threadCount() == 1) {
+        CollisionStats stats;
+        for (const std::vector<uint32_t>& cells : grid.colorCells)
+            for (uint32_t cell : cells)
+                collideCell(balls, grid, cell, 0, stats, contacts);
+        return stats;
+    }
+
+    std::vector<WorkerCollisionStats>& workerStats = grid.workerStats;
+    workerStats.assign(pool->threadCount(), WorkerCollisionStats());
+    for (const std::vector<uint32_t>& cells : grid.colorCells) {
+        pool->parallelFor(cells.size(), 16, [&](size_t begin, size_t end, unsigned worker) {
+            for (size_t c = begin; c < end; ++c)
+                collideCell(balls, grid, cells[c], worker, workerStats[worker].stats, contacts);
+        });
+    }
+
+    CollisionStats stats;
+    for (const WorkerCollisionStats& w : workerStats) {
+        stats.pairTests += w.stats.pairTests;
+        stats.collisions += w.stats.collisions;
+        stats.contactIterations += w.stats.contactIterations;
+        stats.warmStarts += w.stats.warmStarts;
+    }
+    return stats;
+}
+
+CollisionStats collideBallsBruteForce(BallStore& balls) {
+    Span<float> x = balls.x();
+    Span<float> y = balls.y();
+    CollisionStats stats;
+    for (size_t i = 0; i < balls.size(); ++i) {
+        for (size_t j = i + 1; j < balls.size(); ++j) {
+            ++stats.pairTests;
+            float dx = x[j] - x[i];
+            float dy = y[j] - y[i];
+            float dist = std::sqrt(dx * dx + dy * dy);
+            if (dist < 2 * BALL_RADIUS) {
+                resolveBallCollision(balls, i, j);
+                ++stats.collisions;
+            }
+        }
+    }
+    return stats;
+}
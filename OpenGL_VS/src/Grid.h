@@ -0,0 +1,55 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "Globals.h"
+#include "BallStore.h"
+#include "VirtualArray.h"
+
+class ThreadPool;
+class ContactCache;
+
+constexpr int GRID_CELL_COUNT = GRID_DIM * GRID_DIM;
+
+struct CollisionStats {
+    size_t pairTests = 0;
+    size_t collisions = 0;
+    size_t contactIterations = 0; // solverrondes, opgeteld over de cellen
+    size_t warmStarts = 0;        // contacten die met de impuls van de vorige stap begonnen
+};
+
+// Per worker opgeteld; opgevuld tot een cache line tegen false sharing.
+struct WorkerCollisionStats {
+    CollisionStats stats;
+    char pad[64 - sizeof(CollisionStats)];
+};
+
+// Uniform grid over de arena, elke stap opnieuw opgebouwd met een counting sort.
+struct UniformGrid {
+    std::vector<uint32_t> cellStart;   // GRID_CELL_COUNT + 1 offsets in sortedBalls
+    VirtualArray<uint32_t> sortedBalls; // ball-indices gesorteerd op cel
+    VirtualArray<uint32_t> ballCell;    // cel per ball
+    std::vector<uint32_t> chunkCounts; // histogram per stuk bij een parallelle build
+    std::vector<WorkerCollisionStats> workerStats;
+
+    // Cellen per kleur van het 3x3 schaakbord; cellen met dezelfde kleur liggen
+    // minstens drie cellen uit elkaar en hun buren overlappen dus niet.
+    std::vector<uint32_t> colorCells[9];
+
+    UniformGrid();
+    void build(const BallStore& balls, ThreadPool* pool = nullptr);
+};
+
+int gridCellCoord(float p);
+
+// Test alleen paren in de 3x3 naburige cellen. Met een pool worden de cellen
+// per schaakbordkleur parallel verwerkt, zodat geen twee threads dezelfde bal
+// schrijven; het resultaat hangt niet af van het aantal threads.
+// Met contacts gaan rakende paren per cel naar de contactsolver in plaats van
+// een voor een naar resolveBallCollision.
+CollisionStats collideBallsGrid(BallStore& balls, UniformGrid& grid, ThreadPool* pool = nullptr,
+    ContactCache* contacts = nullptr);
+
+// Oude O(n^2) pair loop, bewaard als referentie voor de benchmark.
+CollisionStats collideBallsBruteForce(BallStore& balls);
@@ -0,0 +1,119 @@
+#include "KernelRegistry.h"
+#include "CpuFeatures.h"
+#include "PairKernel.h"
+#include "Random.h"
+#include "WallKernel.h"
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+static const KernelIsa ALL_ISAS[] = { KernelIsa::Scalar, KernelIsa::SSE2, KernelIsa::SSE42, KernelIsa::AVX2,
+    KernelIsa::AVX512 };
+
+const char* kernelIsaName(KernelIsa isa) {
+    switch (isa) {
+    case KernelIsa::SSE2: return "sse2";
+    case KernelIsa::SSE42: return "sse4.2";
+    case KernelIsa::AVX2: return "avx2";
+    case KernelIsa::AVX512: return "avx512";
+    default: return "scalar";
+    }
+}
+
+bool parseKernelIsa(const char* text, KernelIsa& isa) {
+    for (KernelIsa candidate : ALL_ISAS) {
+        if (std::strcmp(text, kernelIsaName(candidate)) == 0) {
+            isa = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool kernelIsaSupported(KernelIsa isa) {
+    const CpuFeatures& cpu = cpuFeatures();
+    switch (isa) {
+    case KernelIsa::SSE2: return cpu.sse2;
+    case KernelIsa::SSE42: return cpu.sse2 && cpu.sse42;
+    // TARGET_AVX2 en TARGET_AVX512 mogen FMA gebruiken
+    case KernelIsa::AVX2: return cpu.avx2 && cpu.fma;
+    case KernelIsa::AVX512: return cpu.avx2 && cpu.fma && cpu.avx512f;
+    default: return true;
+    }
+}
+
+// Voor meldingen: wat kernelIsaSupported voor isa van de CPU vraagt.
+static const char* kernelIsaRequirement(KernelIsa isa) {
+    switch (isa) {
+    case KernelIsa::SSE2: return "SSE2";
+    case KernelIsa::SSE42: return "SSE2 and SSE4.2";
+    case KernelIsa::AVX2: return "AVX2 and FMA";
+    case KernelIsa::AVX512: return "AVX2, FMA and AVX-512F";
+    default: return "nothing";
+    }
+}
+
+// getenv is onder MSVC met SDL-checks een fout
+static std::string environment(const char* name) {
+#if defined(_MSC_VER)
+    char* value = nullptr;
+    size_t length = 0;
+    std::string result;
+    if (_dupenv_s(&value, &length, name) == 0 && value) result = value;
+    std::free(value);
+    return result;
+#else
+    const char* value = std::getenv(name);
+    return value ? value : "";
+#endif
+}
+
+static KernelIsa readIsaLimit() {
+    std::string value = environment("BALLS_ISA");
+    KernelIsa limit = KernelIsa::AVX512;
+    if (!value.empty() && !parseKernelIsa(value.c_str(), limit)) {
+        std::cerr << "Unknown BALLS_ISA " << value << " (scalar, sse2, sse4.2, avx2 or avx512), ignored" << std::endl;
+        limit = KernelIsa::AVX512;
+    }
+    else if (!value.empty() && !kernelIsaSupported(limit)) {
+        std::cerr << "BALLS_ISA " << value << " needs " << kernelIsaRequirement(limit)
+            << ", which this CPU does not report; using the best level below it" << std::endl;
+    }
+    return limit;
+}
+
+KernelIsa kernelIsaLimit() {
+    static const KernelIsa limit = readIsaLimit();
+    return limit;
+}
+
+template <typename Fn>
+static void printFamily(std::ostream& out, const char* family, const char* what,
+    const KernelVariant<Fn>* variants, size_t count) {
+    const KernelVariant<Fn>& picked = pickKernel(variants, count);
+    out << "  " << family << " (" << what << "):";
+    for (size_t k = 0; k < count; ++k) {
+        out << ' ';
+        if (&variants[k] == &picked) out << '[' << kernelIsaName(variants[k].isa) << ']';
+        else if (!kernelIsaSupported(variants[k].isa)) out << '(' << kernelIsaName(variants[k].isa) << ')';
+        else out << kernelIsaName(variants[k].isa);
+    }
+    out << '\n';
+}
+
+void printKernels(std::ostream& out) {
+    out << "cpu:";
+    for (KernelIsa isa : ALL_ISAS)
+        if (isa != KernelIsa::Scalar && kernelIsaSupported(isa)) out << ' ' << kernelIsaName(isa);
+    out << '\n';
+    std::string env = environment("BALLS_ISA");
+    KernelIsa parsed;
+    out << "limit: " << kernelIsaName(kernelIsaLimit())
+        << (env.empty() ? " (BALLS_ISA not set)" : parseKernelIsa(env.c_str(), parsed) ? " (BALLS_ISA)" : " (BALLS_ISA ignored)")
+        << '\n';
+    out << "kernels ([picked], (not supported by this cpu)):\n";
+    printFamily(out, "wall", "integrate + wall reflection", WALL_KERNELS, WALL_KERNEL_COUNT);
+    printFamily(out, "pair", "neighbour list pair test + resolve", PAIR_KERNELS, PAIR_KERNEL_COUNT);
+    printFamily(out, "directions", "spawn directions", DIRECTION_KERNELS, DIRECTION_KERNEL_COUNT);
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <ostream>
+
+// ISA-niveaus, oplopend: een CPU die een niveau aankan, kan ook alles eronder.
+enum class KernelIsa {
+    Scalar,
+    SSE2,
+    SSE42,
+    AVX2,
+    AVX512
+};
+
+const char* kernelIsaName(KernelIsa isa);
+bool parseKernelIsa(const char* text, KernelIsa& isa);
+
+// Of de CPU en het OS isa aankunnen (cpuid, zie cpuFeatures()).
+bool kernelIsaSupported(KernelIsa isa);
+
+// Hoogste niveau dat gekozen mag worden: de omgevingsvariabele BALLS_ISA
+// (scalar, sse2, sse4.2, avx2 of avx512), zonder BALLS_ISA geen limiet. Zo is
+// op een snelle machine na te spelen wat een oudere zou kiezen. Wordt een keer
+// gelezen; een onbekende waarde geeft een melding en wordt genegeerd, een
+// niveau dat de CPU niet aankan geeft een melding en werkt als limiet.
+KernelIsa kernelIsaLimit();
+
+// Een versie van een kernel voor een ISA-niveau. Elke familie heeft een tabel
+// van varianten, oplopend op ISA, met de scalaire versie voorop.
+template <typename Fn>
+struct KernelVariant {
+    KernelIsa isa;
+    Fn fn;
+};
+
+// De hoogste variant die de CPU aankan en binnen kernelIsaLimit() valt; de
+// scalaire versie als er niets beters is.
+template <typename Fn>
+const KernelVariant<Fn>& pickKernel(const KernelVariant<Fn>* variants, size_t count) {
+    size_t best = 0;
+    for (size_t k = 1; k < count; ++k) {
+        if (variants[k].isa <= kernelIsaLimit() && kernelIsaSupported(variants[k].isa))
+            best = k;
+    }
+    return variants[best];
+}
+
+// Voor --list-kernels: wat de CPU kan, de limiet en per familie alle
+// varianten met de gekozen.
+void printKernels(std::ostream& out);
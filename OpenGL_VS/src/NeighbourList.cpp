@@ -0,0 +1,252 @@
+#include "NeighbourList.h"
+#include "ContactCache.h"
+#include "ThreadPool.h"
+#include "Physics.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <cstring>
+
+static int neighbourCellCoord(float p) {
+    int c = static_cast<int>((p + CIRCLE_RADIUS) / NEIGHBOUR_CUTOFF);
+    if (c < 0) return 0;
+    if (c >= NEIGHBOUR_GRID_DIM) return NEIGHBOUR_GRID_DIM - 1;
+    return c;
+}
+
+// Test een paar uit de lijst met dezelfde afstandstest als de grid.
+static inline void collidePair(BallStore& balls, uint32_t i, uint32_t j, CollisionStats& stats) {
+    Span<float> x = balls.x();
+    Span<float> y = balls.y();
+    ++stats.pairTests;
+    float dx = x[j] - x[i];
+    float dy = y[j] - y[i];
+    if (dx * dx + dy * dy < 4 * BALL_RADIUS * BALL_RADIUS) {
+        resolveBallCollision(balls, i, j);
+        ++stats.collisions;
+    }
+}
+
+NeighbourList::NeighbourList()
+    : cellStart(NEIGHBOUR_CELL_COUNT + 1, 0), pairStart(NEIGHBOUR_CELL_COUNT + 1, 0),
+      cellWorker(NEIGHBOUR_CELL_COUNT, 0), cellOffset(NEIGHBOUR_CELL_COUNT, 0), kernel(selectPairKernel()) {
+    for (int cy = 0; cy < NEIGHBOUR_GRID_DIM; ++cy)
+        for (int cx = 0; cx < NEIGHBOUR_GRID_DIM; ++cx)
+            colorCells[(cy % 3) * 3 + cx % 3].push_back(cy * NEIGHBOUR_GRID_DIM + cx);
+}
+
+void NeighbourList::clear() {
+    built = false;
+    builtCount = 0;
+    spawnedCount = 0;
+}
+
+bool NeighbourList::needsRebuild(const BallStore& balls) const {
+    if (!built || builtCount + spawnedCount != balls.size()) return true;
+
+    Span<const float> x = balls.x();
+    Span<const float> y = balls.y();
+    const float limit = 0.25f * NEIGHBOUR_SKIN * NEIGHBOUR_SKIN;
+    for (size_t i = 0; i < balls.size(); ++i) {
+        float dx = x[i] - refX[i];
+        float dy = y[i] - refY[i];
+        if (dx * dx + dy * dy > limit) return true;
+    }
+    return false;
+}
+
+bool NeighbourList::build(const BallStore& balls, ThreadPool* pool) {
+    PROFILE_SCOPE("neighbours");
+    const size_t n = balls.size();
+    refX.reserve(n);
+    refY.reserve(n);
+    sortedBalls.reserve(n);
+    ballCell.reserve(n);
+    if (n) {
+        std::memcpy(refX.data(), balls.x().data(), n * sizeof(float));
+        std::memcpy(refY.data(), balls.y().data(), n * sizeof(float));
+    }
+
+    // Counting sort op cel, zoals UniformGrid::build
+    std::fill(cellStart.begin(), cellStart.end(), 0);
+    for (size_t i = 0; i < n; ++i) {
+        uint32_t cell = neighbourCellCoord(refY[i]) * NEIGHBOUR_GRID_DIM + neighbourCellCoord(refX[i]);
+        ballCell[i] = cell;
+        ++cellStart[cell + 1];
+    }
+    for (size_t c = 0; c < NEIGHBOUR_CELL_COUNT; ++c)
+        cellStart[c + 1] += cellStart[c];
+    for (size_t i = 0; i < n; ++i)
+        sortedBalls[cellStart[ballCell[i]]++] = static_cast<uint32_t>(i);
+    for (size_t c = NEIGHBOUR_CELL_COUNT; c > 0; --c)
+        cellStart[c] = cellStart[c - 1];
+    cellStart[0] = 0;
+
+    // Alleen de eerste opbouw maakt de werkbuffers aan
+    const unsigned workers = pool ? pool->threadCount() : 1;
+    if (workerUsed.size() < workers) {
+        workerPairs.reset(new VirtualArray<BallPair>[workers]);
+        workerUsed.resize(workers);
+    }
+    std::fill(workerUsed.begin(), workerUsed.end(), 0);
+
+    // Een werker zet de paren van zijn cellen achter elkaar in zijn eigen buffer
+    auto buildCells = [&](size_t begin, size_t end, unsigned worker) {
+        for (size_t c = begin; c < end; ++c) {
+            cellWorker[c] = worker;
+            cellOffset[c] = workerUsed[worker];
+            pairStart[c + 1] = buildCell(static_cast<uint32_t>(c), workerPairs[worker], workerUsed[worker]);
+        }
+    };
+    auto copyCells = [&](size_t begin, size_t end, unsigned) {
+        for (size_t c = begin; c < end; ++c) {
+            const size_t count = pairStart[c + 1] - pairStart[c];
+            if (count)
+                std::memcpy(pairs.data() + pairStart[c], workerPairs[cellWorker[c]].data() + cellOffset[c],
+                    count * sizeof(BallPair));
+        }
+    };
+    if (pool) pool->parallelFor(NEIGHBOUR_CELL_COUNT, 16, buildCells);
+    else buildCells(0, NEIGHBOUR_CELL_COUNT, 0);
+
+    // Een volle werker heeft paren overgeslagen; ook het totaal moet passen
+    bool full = false;
+    for (size_t used : workerUsed)
+        full = full || used == VIRTUAL_ARRAY_MAX_ELEMENTS;
+    size_t total = 0;
+    pairStart[0] = 0;
+    for (size_t c = 0; c < NEIGHBOUR_CELL_COUNT; ++c) {
+        total += pairStart[c + 1];
+        pairStart[c + 1] = static_cast<uint32_t>(total);
+    }
+    if (full || total > VIRTUAL_ARRAY_MAX_ELEMENTS) {
+        clear();
+        return false;
+    }
+    pairs.reserve(total);
+    if (pool) pool->parallelFor(NEIGHBOUR_CELL_COUNT, 16, copyCells);
+    else copyCells(0, NEIGHBOUR_CELL_COUNT, 0);
+
+    // Een bal gespawnd binnen SPAWN_SEARCH_RADIUS kan tot de volgende opbouw
+    // alleen deze ballen raken
+    const float region = SPAWN_SEARCH_RADIUS + NEIGHBOUR_CUTOFF;
+    regionBalls.reserve(n);
+    regionCount = 0;
+    for (size_t i = 0; i < n; ++i)
+        if (refX[i] * refX[i] + refY[i] * refY[i] < region * region)
+            regionBalls[regionCount++] = static_cast<uint32_t>(i);
+
+    spawnedCount = 0;
+    builtCount = n;
+    built = true;
+    ++rebuilds;
+    return true;
+}
+
+// Paren waarvan de eerste bal in cell ligt; eigendom zoals bij de grid.
+uint32_t NeighbourList::buildCell(uint32_t cell, VirtualArray<BallPair>& out, size_t& used) const {
+    uint32_t count = 0;
+    int cx = static_cast<int>(cell % NEIGHBOUR_GRID_DIM);
+    int cy = static_cast<int>(cell / NEIGHBOUR_GRID_DIM);
+
+    for (uint32_t a = cellStart[cell]; a < cellStart[cell + 1]; ++a) {
+        uint32_t i = sortedBalls[a];
+
+        for (int ny = cy - 1; ny <= cy + 1; ++ny) {
+            if (ny < 0 || ny >= NEIGHBOUR_GRID_DIM) continue;
+            for (int nx = cx - 1; nx <= cx + 1; ++nx) {
+                if (nx < 0 || nx >= NEIGHBOUR_GRID_DIM) continue;
+
+                uint32_t other = ny * NEIGHBOUR_GRID_DIM + nx;
+                if (other < cell) continue;
+                uint32_t first = other == cell ? a + 1 : cellStart[other];
+
+                for (uint32_t k = first; k < cellStart[other + 1]; ++k) {
+                    uint32_t j = sortedBalls[k];
+                    float dx = refX[j] - refX[i];
+                    float dy = refY[j] - refY[i];
+                    if (dx * dx + dy * dy < NEIGHBOUR_CUTOFF * NEIGHBOUR_CUTOFF) {
+                        if (used == out.capacity()) {
+                            if (used == VIRTUAL_ARRAY_MAX_ELEMENTS) return count;
+                            out.reserve(used + 1);
+                        }
+                        out[used++] = { i, j };
+                        ++count;
+                    }
+                }
+            }
+        }
+    }
+    return count;
+}
+
+void NeighbourList::addSpawned(const BallStore& balls, size_t first, size_t count) {
+    refX.reserve(first + count);
+    refY.reserve(first + count);
+    spawned.reserve(spawnedCount + count);
+    for (size_t k = first; k < first + count; ++k) {
+        refX[k] = balls.x()[k];
+        refY[k] = balls.y()[k];
+        spawned[spawnedCount++] = static_cast<uint32_t>(k);
+    }
+}
+
+void NeighbourList::collideCell(BallStore& balls, uint32_t cell, unsigned worker, CollisionStats& stats,
+    ContactCache* contacts) const {
+    const BallPair* cellPairs = pairs.data() + pairStart[cell];
+    const size_t count = pairStart[cell + 1] - pairStart[cell];
+    if (!contacts) {
+        // De meeste cellen zijn leeg; dan niet eens de kernel aanroepen
+        if (count) kernel.fn(balls, cellPairs, count, stats);
+        return;
+    }
+
+    Span<float> x = balls.x();
+    Span<float> y = balls.y();
+    for (size_t k = 0; k < count; ++k) {
+        const BallPair& p = cellPairs[k];
+        ++stats.pairTests;
+        float dx = x[p.j] - x[p.i];
+        float dy = y[p.j] - y[p.i];
+        if (dx * dx + dy * dy < 4 * BALL_RADIUS * BALL_RADIUS) {
+            if (!contacts->add(balls, cell, worker, p.i, p.j)) resolveBallCollision(balls, p.i, p.j);
+            ++stats.collisions;
+        }
+    }
+    contacts->solveCell(balls, cell, stats);
+}
+
+CollisionStats NeighbourList::collide(BallStore& balls, ThreadPool* pool, ContactCache* contacts) {
+    PROFILE_SCOPE("narrowphase");
+    CollisionStats stats;
+
+    if (!pool || pool->threadCount() == 1) {
+        for (const std::vector<uint32_t>& cells : colorCells)
+            for (uint32_t cell : cells)
+                collideCell(balls, cell, 0, stats, contacts);
+    }
+    else {
+        workerStats.assign(pool->threadCount(), WorkerCollisionStats());
+        for (const std::vector<uint32_t>& cells : colorCells) {
+            pool->parallelFor(cells.size(), 16, [&](size_t begin, size_t end, unsigned worker) {
+                for (size_t c = begin; c < end; ++c)
+                    collideCell(balls, cells[c], worker, workerStats[worker].stats, contacts);
+            });
+        }
+        for (const WorkerCollisionStats& w : workerStats) {
+            stats.pairTests += w.stats.pairTests;
+            stats.collisions += w.stats.collisions;
+            stats.contactIterations += w.stats.contactIterations;
+            stats.warmStarts += w.stats.warmStarts;
+        }
+    }
+
+    // Gespawnde ballen horen bij geen enkele cel, dus serieel na de kleuren
+    for (size_t s = 0; s < spawnedCount; ++s) {
+        uint32_t k = spawned[s];
+        for (size_t r = 0; r < regionCount; ++r)
+            collidePair(balls, regionBalls[r], k, stats);
+        for (size_t t = 0; t < s; ++t)
+            collidePair(balls, spawned[t], k, stats);
+    }
+    return stats;
+}
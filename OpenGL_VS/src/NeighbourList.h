@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "Globals.h"
+#include "BallStore.h"
+#include "Grid.h"
+#include "PairKernel.h"
+#include "VirtualArray.h"
+
+class ThreadPool;
+class ContactCache;
+
+constexpr int NEIGHBOUR_CELL_COUNT = NEIGHBOUR_GRID_DIM * NEIGHBOUR_GRID_DIM;
+
+// Verlet-buurlijst: alle paren die bij de laatste opbouw dichter dan
+// NEIGHBOUR_CUTOFF bij elkaar lagen. Zolang geen bal meer dan NEIGHBOUR_SKIN / 2
+// van zijn opbouwpositie af staat, zit elk paar dat nu kan botsen in de lijst en
+// hoeft de broadphase niet opnieuw.
+//
+// Paren horen bij de cel van hun eerste bal bij de opbouw en staan per cel
+// achter elkaar in een platte array. Elke werker zet de paren van zijn cellen
+// eerst in een eigen VirtualArray; met de aantallen per cel geeft een
+// prefixsom de offsets en daarna gaat alles in een keer naar de platte array.
+// Zo groeit alleen address space mee en alloceert een opbouw bij een gelijk
+// aantal ballen niets. Cellen zijn zo groot
+// als de cutoff, dus dezelfde schaakbordkleuring als UniformGrid houdt parallel
+// verwerkte cellen disjunct en het resultaat hangt niet af van het aantal threads.
+//
+// Ballen die na de opbouw gespawnd zijn, staan apart: die worden getest tegen
+// elkaar en tegen de ballen die bij de opbouw in het spawngebied lagen (binnen
+// SPAWN_SEARCH_RADIUS plus de cutoff van de oorsprong).
+class NeighbourList {
+public:
+    NeighbourList();
+
+    // Vergeet de lijst; de volgende needsRebuild geeft true.
+    void clear();
+
+    bool needsRebuild(const BallStore& balls) const;
+    // false als de paren niet in een VirtualArray passen; de lijst is dan leeg
+    // en de aanroeper moet deze stap een andere broadphase gebruiken.
+    bool build(const BallStore& balls, ThreadPool* pool = nullptr);
+
+    // Meldt count ballen vanaf index first aan, net gespawnd in het spawngebied.
+    void addSpawned(const BallStore& balls, size_t first, size_t count);
+
+    // Met contacts gaan de rakende paren van een cel naar de contactsolver;
+    // de gespawnde ballen blijven een voor een via resolveBallCollision gaan.
+    CollisionStats collide(BallStore& balls, ThreadPool* pool = nullptr, ContactCache* contacts = nullptr);
+
+    uint64_t rebuildCount() const { return rebuilds; }
+
+    // Zonder contactsolver gaan de paren van een cel door deze kernel.
+    const PairKernel& pairKernel() const { return kernel; }
+
+private:
+    // Zet de paren van cell achter used in out; geeft het aantal. Zit out vol
+    // (VIRTUAL_ARRAY_MAX_ELEMENTS), dan stopt het daar.
+    uint32_t buildCell(uint32_t cell, VirtualArray<BallPair>& out, size_t& used) const;
+    void collideCell(BallStore& balls, uint32_t cell, unsigned worker, CollisionStats& stats,
+        ContactCache* contacts) const;
+
+    bool built = false;
+    size_t builtCount = 0;
+    uint64_t rebuilds = 0;
+
+    VirtualArray<float> refX;         // positie bij de opbouw
+    VirtualArray<float> refY;
+    VirtualArray<uint32_t> sortedBalls;
+    VirtualArray<uint32_t> ballCell;
+    std::vector<uint32_t> cellStart;  // NEIGHBOUR_CELL_COUNT + 1 offsets in sortedBalls
+
+    VirtualArray<BallPair> pairs;
+    std::vector<uint32_t> pairStart;  // NEIGHBOUR_CELL_COUNT + 1 offsets in pairs
+
+    // Per werker tijdens de opbouw; per cel waar zijn paren daar staan
+    std::unique_ptr<VirtualArray<BallPair>[]> workerPairs;
+    std::vector<size_t> workerUsed;
+    std::vector<uint32_t> cellWorker;
+    std::vector<size_t> cellOffset;
+    std::vector<uint32_t> colorCells[9];
+
+    VirtualArray<uint32_t> regionBalls; // bij de opbouw in het spawngebied
+    size_t regionCount = 0;
+    VirtualArray<uint32_t> spawned;     // sinds de opbouw gespawnd
+    size_t spawnedCount = 0;
+
+    std::vector<WorkerCollisionStats> workerStats;
+    PairKernel kernel;
+};
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstddef>
+#include "Ball.h"
+#include "BallStore.h"
+#include "Grid.h"
+#include "KernelRegistry.h"
+
+// Test count paren in volgorde met de afstandstest van de narrowphase en lost
+// elk rakend paar op met resolveBallCollision. Een botsing verschuift ballen
+// die latere paren lezen, dus elke variant moet de paren in deze volgorde
+// afhandelen; dan is het resultaat gelijk op elke CPU.
+typedef void (*PairKernelFn)(BallStore& balls, const BallPair* pairs, size_t count, CollisionStats& stats);
+
+struct PairKernel {
+    const char* name;
+    PairKernelFn fn;
+};
+
+void collidePairsScalar(BallStore& balls, const BallPair* pairs, size_t count, CollisionStats& stats);
+
+// Alle varianten voor de KernelRegistry, oplopend op ISA.
+extern const KernelVariant<PairKernelFn> PAIR_KERNELS[];
+extern const size_t PAIR_KERNEL_COUNT;
+
+// Kiest de snelste kernel die de CPU ondersteunt, binnen BALLS_ISA.
+PairKernel selectPairKernel();
@@ -0,0 +1,38 @@
+#include "Physics.h"
+#include <cmath>
+
+void resolveBallCollision(Ball& a, Ball& b) {
+    float dx = b.x - a.x;
+    float dy = b.y - a.y;
+    float dist = std::sqrt(dx * dx + dy * dy);
+    if (dist == 0.0f) return;
+
+    float nx = dx / dist;
+    float ny = dy / dist;
+
+    float dvx = b.vx - a.vx;
+    float dvy = b.vy - a.vy;
+    float dot = dvx * nx + dvy * ny;
+
+    if (dot > 0) return;
+
+    float impulse = 2.0f * dot / 2.0f; // equal mass
+    a.vx += impulse * nx;
+    a.vy += impulse * ny;
+    b.vx -= impulse * nx;
+    b.vy -= impulse * ny;
+
+    float overlap = (2 * BALL_RADIUS - dist) / 2.0f;
+    a.x -= overlap * nx;
+    a.y -= overlap * ny;
+    b.x += overlap * nx;
+    b.y += overlap * ny;
+}
+
+void resolveBallCollision(BallStore& balls, size_t i, size_t j) {
+    Ball a = balls.get(i);
+    Ball b = balls.get(j);
+    resolveBallCollision(a, b);
+    balls.set(i, a);
+    balls.set(j, b);
+}
@@ -0,0 +1,9 @@
+#pragma once
+
+#include <cstddef>
+#include "Globals.h"
+#include "Ball.h"
+#include "BallStore.h"
+
+void resolveBallCollision(Ball& a, Ball& b);
+void resolveBallCollision(BallStore& balls, size_t i, size_t j);
@@ -0,0 +1,116 @@
+#include "Profiler.h"
+
+#ifdef BALLS_PROFILE
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+struct ProfileEvent {
+    const char* name;
+    uint64_t startNs;
+    uint64_t endNs;
+};
+
+constexpr size_t PROFILE_RING_SIZE = 1 << 16;
+
+struct ThreadProfile {
+    unsigned tid = 0;
+    uint64_t written = 0; // totaal aantal events; index = written % PROFILE_RING_SIZE
+    std::vector<ProfileEvent> ring;
+};
+
+static std::mutex registryMutex;
+static std::vector<std::unique_ptr<ThreadProfile>> registry;
+
+static uint64_t nowNs() {
+    static const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - epoch).count());
+}
+
+static ThreadProfile& threadProfile() {
+    thread_local ThreadProfile* profile = nullptr;
+    if (!profile) {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        registry.push_back(std::unique_ptr<ThreadProfile>(new ThreadProfile()));
+        profile = registry.back().get();
+        profile->tid = static_cast<unsigned>(registry.size());
+        profile->ring.resize(PROFILE_RING_SIZE);
+    }
+    return *profile;
+}
+
+ProfileScope::ProfileScope(const char* scopeName)
+    : name(scopeName), startNs(nowNs()) {
+}
+
+ProfileScope::~ProfileScope() {
+    ThreadProfile& profile = threadProfile();
+    profile.ring[profile.written % PROFILE_RING_SIZE] = { name, startNs, nowNs() };
+    ++profile.written;
+}
+
+bool profilerWriteChromeTrace(const char* path) {
+    FILE* f = std::fopen(path, "w");
+    if (!f) return false;
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+    std::fputs("{\"traceEvents\":[\n", f);
+    bool first = true;
+    for (const std::unique_ptr<ThreadProfile>& profile : registry) {
+        uint64_t count = profile->written < PROFILE_RING_SIZE ? profile->written : PROFILE_RING_SIZE;
+        for (uint64_t k = profile->written - count; k < profile->written; ++k) {
+            const ProfileEvent& e = profile->ring[k % PROFILE_RING_SIZE];
+            std::fprintf(f, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                first ? "" : ",\n", e.name, profile->tid, e.startNs / 1000.0, (e.endNs - e.startNs) / 1000.0);
+            first = false;
+        }
+    }
+    std::fputs("\n],\"displayTimeUnit\":\"ms\"}\n", f);
+    std::fclose(f);
+    return true;
+}
+
+void profilerPhases(ProfilePhases& out) {
+    struct Phase {
+        const char* name;
+        uint64_t totalNs;
+        unsigned count;
+    };
+
+    ThreadProfile& profile = threadProfile();
+    const uint64_t now = nowNs();
+    const uint64_t windowStart = now > 1000000000ull ? now - 1000000000ull : 0; // de klok begint bij nul
+    Phase phases[PROFILE_MAX_PHASES];
+    size_t phaseCount = 0;
+
+    uint64_t count = profile.written < PROFILE_RING_SIZE ? profile.written : PROFILE_RING_SIZE;
+    for (uint64_t k = profile.written; k > profile.written - count; --k) {
+        const ProfileEvent& e = profile.ring[(k - 1) % PROFILE_RING_SIZE];
+        if (e.endNs < windowStart) break;
+
+        Phase* phase = nullptr;
+        for (size_t p = 0; p < phaseCount && !phase; ++p)
+            if (std::strcmp(phases[p].name, e.name) == 0) phase = &phases[p];
+        if (!phase) {
+            if (phaseCount == PROFILE_MAX_PHASES) continue;
+            phases[phaseCount] = { e.name, 0, 0 };
+            phase = &phases[phaseCount++];
+        }
+        phase->totalNs += e.endNs - e.startNs;
+        ++phase->count;
+    }
+
+    // phases staat van nieuw naar oud; achterstevoren is de volgorde in de frame
+    out.count = 0;
+    for (size_t i = phaseCount; i > 0; --i) {
+        const Phase& p = phases[i - 1];
+        out.phase[out.count++] = { p.name, static_cast<float>(p.totalNs / 1e6 / p.count) };
+    }
+}
+
+#endif
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Lichte scope-timers per fase. Alleen actief als BALLS_PROFILE gedefinieerd
+// is; anders zijn de macro's leeg en kost de profiler niets.
+//
+// Elke thread schrijft naar een eigen ringbuffer met steady_clock-tijden,
+// dus er zit geen lock in het meetpad. Bij afsluiten kan alles als Chrome
+// trace_event JSON weggeschreven worden (chrome://tracing of Perfetto).
+
+// Gemiddelde duur van een fase; name is de string literal van PROFILE_SCOPE,
+// dus een ProfilePhases kan gewoon gekopieerd worden naar een andere thread.
+struct ProfilePhase {
+    const char* name;
+    float ms;
+};
+
+constexpr size_t PROFILE_MAX_PHASES = 16;
+
+struct ProfilePhases {
+    ProfilePhase phase[PROFILE_MAX_PHASES] = {};
+    uint32_t count = 0;
+};
+
+#ifdef BALLS_PROFILE
+
+class ProfileScope {
+public:
+    explicit ProfileScope(const char* name);
+    ~ProfileScope();
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    const char* name;
+    uint64_t startNs;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope_, __LINE__)(name)
+
+// Schrijft de events van alle threads als Chrome trace; false bij een fout.
+bool profilerWriteChromeTrace(const char* path);
+
+// Gemiddelde duur per fase over de laatste seconde, voor de aanroepende
+// thread, in de volgorde van de frame. Alloceert niets; fasen voorbij
+// PROFILE_MAX_PHASES vallen weg.
+void profilerPhases(ProfilePhases& out);
+
+#else
+
+#define PROFILE_SCOPE(name) ((void)0)
+
+inline bool profilerWriteChromeTrace(const char*) { return false; }
+inline void profilerPhases(ProfilePhases& out) { out.count = 0; }
+
+#endif
@@ -0,0 +1,170 @@
+#include "Random.h"
+#include "CpuFeatures.h"
+
+#if BALLS_X86
+#include <immintrin.h>
+#endif
+
+uint64_t splitMix64(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+CounterRng::CounterRng(uint64_t seed)
+    : key(splitMix64(seed)) {
+}
+
+uint32_t CounterRng::u32(uint64_t counter) const {
+    return static_cast<uint32_t>(splitMix64(key ^ (counter * 0xD1B54A32D192ED03ull)) >> 32);
+}
+
+float CounterRng::unit(uint64_t counter) const {
+    return static_cast<float>(u32(counter) >> 8) * (1.0f / 16777216.0f);
+}
+
+// Een richting komt uit een u32: de bovenste 2 bits kiezen het kwadrant, de
+// volgende 24 bits de hoek t binnen [-pi/4, pi/4). sin en cos van t zijn
+// Taylor-polynomen (fout < 1e-8 op dat interval), daarna draait het kwadrant
+// (c, s) over een veelvoud van 90 graden.
+constexpr float HALF_PI = 1.57079632679489661923f;
+constexpr float QUARTER_PI = 0.78539816339744830962f;
+constexpr float INV_2_24 = 1.0f / 16777216.0f;
+constexpr float S3 = -1.0f / 6.0f;
+constexpr float S5 = 1.0f / 120.0f;
+constexpr float S7 = -1.0f / 5040.0f;
+constexpr float S9 = 1.0f / 362880.0f;
+constexpr float C2 = -1.0f / 2.0f;
+constexpr float C4 = 1.0f / 24.0f;
+constexpr float C6 = -1.0f / 720.0f;
+constexpr float C8 = 1.0f / 40320.0f;
+
+static void directionsScalar(const uint32_t* bits, size_t count, float speed, float* vx, float* vy) {
+    for (size_t k = 0; k < count; ++k) {
+        uint32_t q = bits[k] >> 30;
+        float t = static_cast<float>(static_cast<int32_t>((bits[k] >> 6) & 0xFFFFFF)) * INV_2_24;
+        t = t * HALF_PI - QUARTER_PI;
+
+        float t2 = t * t;
+        float s = t * (1.0f + t2 * (S3 + t2 * (S5 + t2 * (S7 + t2 * S9))));
+        float c = 1.0f + t2 * (C2 + t2 * (C4 + t2 * (C6 + t2 * C8)));
+
+        float x = (q & 1) ? s : c;
+        float y = (q & 1) ? c : s;
+        if (q == 1 || q == 2) x = -x;
+        if (q >= 2) y = -y;
+        vx[k] = x * speed;
+        vy[k] = y * speed;
+    }
+}
+
+#if BALLS_X86
+
+TARGET_SSE2 static void directionsSSE2(const uint32_t* bits, size_t count, float speed, float* vx, float* vy) {
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 signBit = _mm_set1_ps(-0.0f);
+    const __m128i three = _mm_set1_epi32(3);
+    const __m128i oneI = _mm_set1_epi32(1);
+    const __m128i twoI = _mm_set1_epi32(2);
+    const __m128 vspeed = _mm_set1_ps(speed);
+
+    size_t k = 0;
+    for (; k + 4 <= count; k += 4) {
+        __m128i r = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bits + k));
+        __m128i q = _mm_and_si128(_mm_srli_epi32(r, 30), three);
+        __m128 t = _mm_mul_ps(_mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(r, 6), _mm_set1_epi32(0xFFFFFF))), _mm_set1_ps(INV_2_24));
+        t = _mm_sub_ps(_mm_mul_ps(t, _mm_set1_ps(HALF_PI)), _mm_set1_ps(QUARTER_PI));
+
+        __m128 t2 = _mm_mul_ps(t, t);
+        __m128 ps = _mm_add_ps(_mm_set1_ps(S7), _mm_mul_ps(t2, _mm_set1_ps(S9)));
+        ps = _mm_add_ps(_mm_set1_ps(S5), _mm_mul_ps(t2, ps));
+        ps = _mm_add_ps(_mm_set1_ps(S3), _mm_mul_ps(t2, ps));
+        ps = _mm_add_ps(one, _mm_mul_ps(t2, ps));
+        __m128 s = _mm_mul_ps(t, ps);
+        __m128 pc = _mm_add_ps(_mm_set1_ps(C6), _mm_mul_ps(t2, _mm_set1_ps(C8)));
+        pc = _mm_add_ps(_mm_set1_ps(C4), _mm_mul_ps(t2, pc));
+        pc = _mm_add_ps(_mm_set1_ps(C2), _mm_mul_ps(t2, pc));
+        __m128 c = _mm_add_ps(one, _mm_mul_ps(t2, pc));
+
+        __m128 swap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(q, oneI), oneI));
+        __m128 x = _mm_or_ps(_mm_and_ps(swap, s), _mm_andnot_ps(swap, c));
+        __m128 y = _mm_or_ps(_mm_and_ps(swap, c), _mm_andnot_ps(swap, s));
+        __m128i negX = _mm_or_si128(_mm_cmpeq_epi32(q, oneI), _mm_cmpeq_epi32(q, twoI));
+        __m128i negY = _mm_cmpgt_epi32(q, oneI);
+        x = _mm_xor_ps(x, _mm_and_ps(_mm_castsi128_ps(negX), signBit));
+        y = _mm_xor_ps(y, _mm_and_ps(_mm_castsi128_ps(negY), signBit));
+
+        _mm_storeu_ps(vx + k, _mm_mul_ps(x, vspeed));
+        _mm_storeu_ps(vy + k, _mm_mul_ps(y, vspeed));
+    }
+    directionsScalar(bits + k, count - k, speed, vx + k, vy + k);
+}
+
+// Bewust zonder FMA: dan rondt elke bewerking hetzelfde af als in de andere versies.
+TARGET_AVX2_NOFMA static void directionsAVX2(const uint32_t* bits, size_t count, float speed, float* vx, float* vy) {
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 signBit = _mm256_set1_ps(-0.0f);
+    const __m256i three = _mm256_set1_epi32(3);
+    const __m256i oneI = _mm256_set1_epi32(1);
+    const __m256i twoI = _mm256_set1_epi32(2);
+    const __m256 vspeed = _mm256_set1_ps(speed);
+
+    size_t k = 0;
+    for (; k + 8 <= count; k += 8) {
+        __m256i r = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bits + k));
+        __m256i q = _mm256_and_si256(_mm256_srli_epi32(r, 30), three);
+        __m256 t = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srli_epi32(r, 6), _mm256_set1_epi32(0xFFFFFF))), _mm256_set1_ps(INV_2_24));
+        t = _mm256_sub_ps(_mm256_mul_ps(t, _mm256_set1_ps(HALF_PI)), _mm256_set1_ps(QUARTER_PI));
+
+        __m256 t2 = _mm256_mul_ps(t, t);
+        __m256 ps = _mm256_add_ps(_mm256_set1_ps(S7), _mm256_mul_ps(t2, _mm256_set1_ps(S9)));
+        ps = _mm256_add_ps(_mm256_set1_ps(S5), _mm256_mul_ps(t2, ps));
+        ps = _mm256_add_ps(_mm256_set1_ps(S3), _mm256_mul_ps(t2, ps));
+        ps = _mm256_add_ps(one, _mm256_mul_ps(t2, ps));
+        __m256 s = _mm256_mul_ps(t, ps);
+        __m256 pc = _mm256_add_ps(_mm256_set1_ps(C6), _mm256_mul_ps(t2, _mm256_set1_ps(C8)));
+        pc = _mm256_add_ps(_mm256_set1_ps(C4), _mm256_mul_ps(t2, pc));
+        pc = _mm256_add_ps(_mm256_set1_ps(C2), _mm256_mul_ps(t2, pc));
+        __m256 c = _mm256_add_ps(one, _mm256_mul_ps(t2, pc));
+
+        __m256 swap = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(q, oneI), oneI));
+        __m256 x = _mm256_blendv_ps(c, s, swap);
+        __m256 y = _mm256_blendv_ps(s, c, swap);
+        __m256i negX = _mm256_or_si256(_mm256_cmpeq_epi32(q, oneI), _mm256_cmpeq_epi32(q, twoI));
+        __m256i negY = _mm256_cmpgt_epi32(q, oneI);
+        x = _mm256_xor_ps(x, _mm256_and_ps(_mm256_castsi256_ps(negX), signBit));
+        y = _mm256_xor_ps(y, _mm256_and_ps(_mm256_castsi256_ps(negY), signBit));
+
+        _mm256_storeu_ps(vx + k, _mm256_mul_ps(x, vspeed));
+        _mm256_storeu_ps(vy + k, _mm256_mul_ps(y, vspeed));
+    }
+    directionsScalar(bits + k, count - k, speed, vx + k, vy + k);
+}
+
+#endif
+
+// Elke versie geeft dezelfde bits, dus de keuze verandert geen run
+const KernelVariant<DirectionsFn> DIRECTION_KERNELS[] = {
+    { KernelIsa::Scalar, directionsScalar },
+#if BALLS_X86
+    { KernelIsa::SSE2, directionsSSE2 },
+    { KernelIsa::AVX2, directionsAVX2 },
+#endif
+};
+const size_t DIRECTION_KERNEL_COUNT = sizeof(DIRECTION_KERNELS) / sizeof(DIRECTION_KERNELS[0]);
+
+void generateDirections(const CounterRng& rng, uint64_t firstCounter, size_t count,
+    float speed, float* vx, float* vy) {
+    static const DirectionsFn directions = pickKernel(DIRECTION_KERNELS, DIRECTION_KERNEL_COUNT).fn;
+
+    // In blokjes zodat de random bits op de stack passen
+    const size_t batch = 256;
+    uint32_t bits[batch];
+    for (size_t done = 0; done < count; done += batch) {
+        size_t n = count - done < batch ? count - done : batch;
+        for (size_t k = 0; k < n; ++k)
+            bits[k] = rng.u32(firstCounter + done + k);
+        directions(bits, n, speed, vx + done, vy + done);
+    }
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "KernelRegistry.h"
+
+// Counter-based generator: de waarde hangt alleen af van (seed, counter), niet
+// van een interne toestand. Elke thread kan dus zonder lock en in willekeurige
+// volgorde trekken, en dezelfde seed geeft altijd dezelfde getallen.
+struct CounterRng {
+    uint64_t key = 0;
+
+    CounterRng() = default;
+    explicit CounterRng(uint64_t seed);
+
+    uint32_t u32(uint64_t counter) const;
+    float unit(uint64_t counter) const; // [0, 1)
+};
+
+uint64_t splitMix64(uint64_t x);
+
+// Schrijft count willekeurige richtingen met lengte speed naar vx/vy; richting
+// k gebruikt counter firstCounter + k. De sincos is een polynoom die door de
+// scalaire, SSE2- en AVX2-versie met exact dezelfde bewerkingen uitgerekend
+// wordt, zodat het resultaat bit voor bit gelijk is op elke CPU.
+void generateDirections(const CounterRng& rng, uint64_t firstCounter, size_t count,
+    float speed, float* vx, float* vy);
+
+// Zet count random bits om in richtingen; de kernel achter generateDirections.
+typedef void (*DirectionsFn)(const uint32_t* bits, size_t count, float speed, float* vx, float* vy);
+
+// Alle varianten voor de KernelRegistry, oplopend op ISA.
+extern const KernelVariant<DirectionsFn> DIRECTION_KERNELS[];
+extern const size_t DIRECTION_KERNEL_COUNT;
@@ -0,0 +1,309 @@
+#include "Simulation.h"
+#include "Checkpoint.h"
+#include "Globals.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <cstring>
+
+// Stukken voor de integratie; een veelvoud van BALL_STORE_LANES zodat elk
+// stuk op een uitgelijnde index begint, en een deler van BALL_STORE_CHUNK zodat
+// elk stuk binnen een chunk valt.
+constexpr size_t INTEGRATE_GRAIN = 64 * BALL_STORE_LANES;
+static_assert(BALL_STORE_CHUNK % INTEGRATE_GRAIN == 0, "een stuk mag geen chunkgrens overschrijden");
+
+// Stukken voor het spawnen; minder nieuwe ballen dan dit gaat in een keer op
+// de aanroepende thread (zie ThreadPool::parallelFor).
+constexpr size_t SPAWN_GRAIN = 1024;
+
+Simulation::Simulation(unsigned threads, double stepHz, uint64_t seed)
+    : pool(threads), kernel(selectWallKernel()), stepScale(static_cast<float>(SIM_REFERENCE_HZ / stepHz)),
+      rngSeed(seed), rng(seed) {
+    reset();
+}
+
+void Simulation::reset() {
+    BallStore start;
+    start.push({ 0.0f, 0.0f, INITIAL_SPEED, INITIAL_SPEED });
+    load(start);
+}
+
+void Simulation::load(const BallStore& balls) {
+    const size_t n = balls.size();
+    store = balls;
+    prevX.reserve(n);
+    prevY.reserve(n);
+    ids.reserve(n);
+    idIndex.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        prevX[i] = store.x()[i];
+        prevY[i] = store.y()[i];
+        ids[i] = idIndex[i] = static_cast<uint32_t>(i);
+    }
+    neighbours.clear();
+    contacts.clear();
+    spawnQueued = 0;
+    droppedSpawns = 0;
+    stats = StepStats();
+    steps = 0;
+    lastReorderStep = 0;
+    sortedLocality = 1.0f;
+}
+
+bool Simulation::saveCheckpoint(const std::string& path, std::string& error) {
+#ifdef _WIN32
+    // Windows kan een bestand niet vervangen zolang er een view op staat;
+    // na een load kopieert de eerste keer opslaan de arrays dus een keer
+    store.detach();
+    prevX.detach();
+    prevY.detach();
+    ids.detach();
+    idIndex.detach();
+#endif
+    CheckpointHeader header = {};
+    header.ballCount = store.size();
+    header.seed = rngSeed;
+    header.steps = steps;
+    header.lastReorderStep = lastReorderStep;
+    header.reorders = reorders;
+    header.pendingSpawns = spawnQueued;
+    header.sortedLocality = sortedLocality;
+    const void* arrays[CHECKPOINT_ARRAY_COUNT] = {
+        store.x().data(), store.y().data(), store.vx().data(), store.vy().data(), ids.data(), idIndex.data()
+    };
+    return writeCheckpoint(path, header, arrays, spawnVx.data(), spawnVy.data(), error);
+}
+
+bool Simulation::loadCheckpoint(const std::string& path, std::string& error) {
+    MappedFile file;
+    CheckpointHeader header;
+    if (!openCheckpoint(path, file, header, error)) return false;
+
+    // De vorige stap is deze stap, net als bij load(): prevX en prevY worden
+    // views op dezelfde pagina's als x en y
+    const size_t n = static_cast<size_t>(header.ballCount);
+    const size_t capacity = static_cast<size_t>(header.capacity);
+    const size_t bytes = capacity * sizeof(float);
+    const uint64_t* at = header.arrayOffset;
+    const size_t pending = static_cast<size_t>(header.pendingSpawns);
+    spawnVx.reserve(pending);
+    spawnVy.reserve(pending);
+    spawnQueued = pending;
+    bool ok = store.adopt(file, at, n, capacity) &&
+        prevX.adopt(file, at[CHECKPOINT_X], bytes) &&
+        prevY.adopt(file, at[CHECKPOINT_Y], bytes) &&
+        ids.adopt(file, at[CHECKPOINT_IDS], bytes) &&
+        idIndex.adopt(file, at[CHECKPOINT_ID_INDEX], bytes) &&
+        file.read(header.spawnOffset, spawnVx.data(), pending * sizeof(float)) &&
+        file.read(header.spawnOffset + pending * sizeof(float), spawnVy.data(), pending * sizeof(float));
+    if (!ok) {
+        error = "cannot read " + path;
+        reset();
+        return false;
+    }
+
+    rngSeed = header.seed;
+    rng = CounterRng(header.seed);
+    steps = header.steps;
+    lastReorderStep = header.lastReorderStep;
+    reorders = header.reorders;
+    sortedLocality = header.sortedLocality;
+    neighbours.clear();
+    contacts.clear();
+    stats = StepStats();
+    return true;
+}
+
+void Simulation::setBroadphase(Broadphase mode) {
+    broadphaseMode = mode;
+    neighbours.clear();
+    contacts.clear(); // andere cellen
+}
+
+void Simulation::setContactMode(ContactMode mode) {
+    contactSolver = mode;
+    contacts.clear();
+    contacts.setWarmStart(mode == ContactMode::Warm);
+}
+
+void Simulation::writeInstances(BallRange range, float alpha, BallInstance* out) const {
+    const float* x = store.x().data();
+    const float* y = store.y().data();
+    const float* px = prevX.data();
+    const float* py = prevY.data();
+    for (size_t i = range.begin; i < range.end; ++i, ++out) {
+        out->x = px[i] + (x[i] - px[i]) * alpha;
+        out->y = py[i] + (y[i] - py[i]) * alpha;
+        out->id = ids[i];
+    }
+}
+
+// Alleen op een controlestap wordt de locality gemeten; dat is een lus over
+// alle ballen, dus niet elke stap.
+bool Simulation::reorderDue() {
+    if (!reorderEnabled || store.size() < REORDER_MIN_BALLS) return false;
+    const uint64_t since = steps - lastReorderStep;
+    if (since == 0 || since % REORDER_CHECK_STEPS != 0) return false;
+    if (since >= static_cast<uint64_t>(REORDER_MAX_STEPS)) return true;
+    return order.locality(store, &pool) < REORDER_MIN_LOCALITY * sortedLocality;
+}
+
+void Simulation::reorder() {
+    const size_t n = store.size();
+    const uint32_t* perm = order.sort(store, &pool);
+    store.permute(perm, reorderStore);
+
+    reorderIds.reserve(n);
+    for (size_t k = 0; k < n; ++k)
+        reorderIds[k] = ids[perm[k]];
+    ids.swap(reorderIds);
+    for (size_t k = 0; k < n; ++k)
+        idIndex[ids[k]] = static_cast<uint32_t>(k);
+
+    // De buurlijst verwijst naar oude indices
+    neighbours.clear();
+    sortedLocality = order.locality(store, &pool);
+    lastReorderStep = steps;
+    ++reorders;
+}
+
+void Simulation::integrateAndReflect() {
+    PROFILE_SCOPE("integrate");
+    const size_t n = store.size();
+    const size_t chunks = (n + INTEGRATE_GRAIN - 1) / INTEGRATE_GRAIN;
+    wallHits.reserve(n);
+    chunkHitStart.reserve(chunks + 1);
+    chunkHitStart[0] = 0;
+
+    // Elk stuk telt zijn eigen hits
+    pool.parallelFor(n, INTEGRATE_GRAIN, [&](size_t begin, size_t end, unsigned) {
+        chunkHitStart[begin / INTEGRATE_GRAIN + 1] = kernel.fn(store, begin, end, stepScale, wallHits.data() + begin);
+    });
+
+    // Prefix sum, zoals UniformGrid::build: hit h van stuk c krijgt spawnplek
+    // chunkHitStart[c] + h, in volgorde van ball-index
+    for (size_t c = 0; c < chunks; ++c)
+        chunkHitStart[c + 1] += chunkHitStart[c];
+    hitCount = chunkHitStart[chunks];
+    stats.wallHits = hitCount;
+}
+
+void Simulation::step() {
+    // Voor het kopieren van de vorige posities, zodat die de nieuwe volgorde volgen
+    stats.reordered = reorderDue();
+    if (stats.reordered) reorder();
+
+    const size_t n = store.size();
+    prevX.reserve(n);
+    prevY.reserve(n);
+    std::memcpy(prevX.data(), store.x().data(), n * sizeof(float));
+    std::memcpy(prevY.data(), store.y().data(), n * sizeof(float));
+
+    integrateAndReflect();
+
+    // Een richting per wandhit; counter = (stap, hit) zodat elke stap eigen
+    // getallen krijgt. De counter hangt alleen van de plek af, dus elk stuk
+    // schrijft zijn eigen plekken en het resultaat is gelijk aan serieel.
+    {
+        PROFILE_SCOPE("spawn");
+        // Alleen zoveel als er onder BALL_STORE_MAX_BALLS nog bij passen; de
+        // laatste hits vallen weg, dus de rest krijgt dezelfde richtingen
+        const size_t deferred = spawnQueued;
+        const size_t room = n + deferred < BALL_STORE_MAX_BALLS ? BALL_STORE_MAX_BALLS - n - deferred : 0;
+        const size_t queued = std::min(hitCount, room);
+        stats.spawnsDropped = hitCount - queued;
+        droppedSpawns += stats.spawnsDropped;
+        spawnVx.reserve(deferred + queued);
+        spawnVy.reserve(deferred + queued);
+        spawnQueued = deferred + queued;
+        float* vx = spawnVx.data() + deferred;
+        float* vy = spawnVy.data() + deferred;
+        const uint64_t counter = steps << 32;
+        pool.parallelFor(queued, SPAWN_GRAIN, [&](size_t begin, size_t end, unsigned) {
+            generateDirections(rng, counter + begin, end - begin, INITIAL_SPEED, vx + begin, vy + begin);
+        });
+    }
+
+    // Past de buurlijst niet (meer dan VIRTUAL_ARRAY_MAX_ELEMENTS paren, zoals
+    // bij ballen op een stapel), dan doet de grid deze stap
+    bool useList = broadphaseMode == Broadphase::NeighbourList;
+    stats.neighbourRebuild = useList && neighbours.needsRebuild(store);
+    stats.neighbourFallback = stats.neighbourRebuild && !neighbours.build(store, &pool);
+    useList = useList && !stats.neighbourFallback;
+
+    // Contacten zijn op id, dus ze overleven een herordening
+    ContactCache* contactCache = nullptr;
+    if (contactSolver != ContactMode::Off) {
+        contacts.beginStep(useList ? NEIGHBOUR_CELL_COUNT : GRID_CELL_COUNT, pool.threadCount(), ids.data());
+        contactCache = &contacts;
+    }
+
+    CollisionStats collisions = useList ? neighbours.collide(store, &pool, contactCache)
+        : collideBallsGrid(store, grid, &pool, contactCache);
+    stats.pairTests = collisions.pairTests;
+    stats.collisions = collisions.collisions;
+    stats.contactIterations = collisions.contactIterations;
+    stats.warmStarts = collisions.warmStarts;
+
+    // Spawnrij in een keer achteraan; de bestaande ballen blijven op hun plek.
+    // Alle plekken staan vooraf klaar, dus de stukken schrijven parallel.
+    const size_t spawned = placeSpawns();
+    PROFILE_SCOPE("append");
+    store.append(spawned);
+    prevX.reserve(n + spawned);
+    prevY.reserve(n + spawned);
+    ids.reserve(n + spawned);
+    idIndex.reserve(n + spawned);
+    Span<float> x = store.x();
+    Span<float> y = store.y();
+    Span<float> vx = store.vx();
+    Span<float> vy = store.vy();
+    pool.parallelFor(spawned, SPAWN_GRAIN, [&](size_t begin, size_t end, unsigned) {
+        for (size_t h = begin; h < end; ++h) {
+            x[n + h] = prevX[n + h] = spawnX[h];
+            y[n + h] = prevY[n + h] = spawnY[h];
+            vx[n + h] = spawnVx[h];
+            vy[n + h] = spawnVy[h];
+            ids[n + h] = idIndex[n + h] = static_cast<uint32_t>(n + h);
+        }
+    });
+    if (broadphaseMode == Broadphase::NeighbourList)
+        neighbours.addSpawned(store, n, spawned);
+
+    // Wat geen plek vond schuift naar voren en gaat de volgende stap voor
+    spawnQueued -= spawned;
+    if (spawned && spawnQueued) {
+        std::memmove(spawnVx.data(), spawnVx.data() + spawned, spawnQueued * sizeof(float));
+        std::memmove(spawnVy.data(), spawnVy.data() + spawned, spawnQueued * sizeof(float));
+    }
+    stats.spawned = spawned;
+    stats.spawnsDeferred = spawnQueued;
+    ++steps;
+}
+
+// Plek voor de ballen in de spawnrij, in volgorde; geeft het aantal dat een
+// plek heeft. Na de botsingen, zodat de posities van deze stap tellen. Het
+// zoeken zelf is serieel: elke plek hangt af van de ballen ervoor.
+size_t Simulation::placeSpawns() {
+    // Hier houdt BALL_STORE_MAX_BALLS de store tegen; de rij is al begrensd,
+    // behalve na een checkpoint dat meer ballen en wachtende spawns had
+    const size_t queued = std::min(spawnQueued, BALL_STORE_MAX_BALLS - store.size());
+    if (spawnMode == SpawnPlacement::Origin) {
+        spawnX.reserve(queued);
+        spawnY.reserve(queued);
+        std::fill(spawnX.data(), spawnX.data() + queued, 0.0f);
+        std::fill(spawnY.data(), spawnY.data() + queued, 0.0f);
+        return queued;
+    }
+    if (queued == 0) return 0;
+
+    // Meer dan een bal per kandidaat past er niet
+    const size_t room = std::min(queued, placer.candidateCount());
+    spawnX.reserve(room);
+    spawnY.reserve(room);
+
+    placer.prepare(store, &pool);
+    size_t placed = 0;
+    while (placed < room && placer.place(spawnX[placed], spawnY[placed]))
+        ++placed;
+    return placed;
+}
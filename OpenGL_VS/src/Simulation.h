@@ -0,0 +1,154 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <string>
+#include "Ball.h"
+#include "Globals.h"
+#include "BallOrder.h"
+#include "BallStore.h"
+#include "ContactCache.h"
+#include "Grid.h"
+#include "NeighbourList.h"
+#include "Random.h"
+#include "SpawnPlacer.h"
+#include "ThreadPool.h"
+#include "VirtualArray.h"
+#include "WallKernel.h"
+
+struct StepStats {
+    size_t wallHits = 0;
+    size_t pairTests = 0;
+    size_t collisions = 0;
+    bool neighbourRebuild = false; // buurlijst deze stap opnieuw opgebouwd
+    bool reordered = false;        // ballen deze stap op Morton-volgorde gezet
+    size_t contactIterations = 0;  // solverrondes over alle cellen
+    size_t warmStarts = 0;
+    size_t spawned = 0;            // deze stap achteraan toegevoegd
+    size_t spawnsDeferred = 0;     // wachten op een vrije plek
+    size_t spawnsDropped = 0;      // wandhits zonder nieuwe bal: BALL_STORE_MAX_BALLS bereikt
+    bool neighbourFallback = false; // buurlijst paste niet, deze stap via de grid
+};
+
+enum class SpawnPlacement {
+    Origin, // elke nieuwe bal precies in de oorsprong
+    Search  // eerste vrije plek rond de oorsprong, anders een stap later (SpawnPlacer)
+};
+
+enum class ContactMode {
+    Off,   // elk rakend paar een keer via resolveBallCollision
+    Cold,  // contactsolver met iteraties, elke stap vanaf impuls nul
+    Warm   // contactsolver, blijvende contacten beginnen met hun vorige impuls
+};
+
+enum class Broadphase {
+    Grid,          // elke stap een nieuwe grid
+    NeighbourList  // Verlet-lijst, alleen opnieuw na genoeg verplaatsing
+};
+
+// De volledige ballensimulatie zonder iets van OpenGL: integratie, botsing
+// met de rand, broadphase + narrowphase en het spawnen van nieuwe ballen.
+class Simulation {
+public:
+    // stepHz bepaalt de grootte van een stap; bij SIM_REFERENCE_HZ legt een bal
+    // per stap precies zijn snelheid af.
+    // seed bepaalt alle spawnrichtingen: dezelfde seed geeft een identieke run,
+    // onafhankelijk van het aantal threads.
+    explicit Simulation(unsigned threads = 1, double stepHz = SIM_REFERENCE_HZ, uint64_t seed = 1);
+
+    void reset();
+    // Begint opnieuw met de gegeven ballen; hun ids zijn hun indices.
+    void load(const BallStore& balls);
+    void step();
+
+    // Schrijft de volledige toestand naar een checkpoint (zie Checkpoint.h):
+    // ballen, ids, seed, stapteller en de spawnrij.
+    bool saveCheckpoint(const std::string& path, std::string& error);
+    // Gaat verder vanaf een checkpoint. De arrays worden copy-on-write gemapt
+    // in plaats van gelezen, dus ook miljoenen ballen zijn in milliseconden
+    // terug. De broadphase en contacten worden opnieuw opgebouwd; verder loopt
+    // de run daarna hetzelfde voor elke keer dat het checkpoint geladen wordt.
+    // Bij false is de simulatie gereset.
+    bool loadCheckpoint(const std::string& path, std::string& error);
+
+    const BallStore& balls() const { return store; }
+    const StepStats& lastStats() const { return stats; }
+    const WallKernel& wallKernel() const { return kernel; }
+    const PairKernel& pairKernel() const { return neighbours.pairKernel(); }
+    Broadphase broadphase() const { return broadphaseMode; }
+    void setBroadphase(Broadphase mode);
+    ContactMode contactMode() const { return contactSolver; }
+    void setContactMode(ContactMode mode);
+    SpawnPlacement spawnPlacement() const { return spawnMode; }
+    void setSpawnPlacement(SpawnPlacement mode) { spawnMode = mode; }
+    size_t pendingSpawns() const { return spawnQueued; }
+    // Wandhits sinds de start die geen bal meer opleverden (BALL_STORE_MAX_BALLS).
+    uint64_t spawnsDropped() const { return droppedSpawns; }
+    uint64_t neighbourRebuilds() const { return neighbours.rebuildCount(); }
+    unsigned threadCount() const { return pool.threadCount(); }
+    uint64_t seed() const { return rngSeed; }
+    uint64_t stepCount() const { return steps; }
+
+    // De ballen worden af en toe in het geheugen herordend (zie reorder); een
+    // id blijft bij zijn bal. Ids zijn de volgorde van ontstaan, dus 0 tot size().
+    uint32_t ballId(size_t index) const { return ids[index]; }
+    size_t indexOfId(uint32_t id) const { return idIndex[id]; }
+    bool reordering() const { return reorderEnabled; }
+    void setReordering(bool enabled) { reorderEnabled = enabled; }
+    uint64_t reorderCount() const { return reorders; }
+
+    // Posities tussen de vorige en de huidige stap, voor het tekenen, voor de
+    // ballen in range naar out.
+    void writeInstances(BallRange range, float alpha, BallInstance* out) const;
+
+private:
+    void integrateAndReflect();
+    bool reorderDue();
+    void reorder();
+    size_t placeSpawns();
+
+    ThreadPool pool;
+    BallStore store;
+    UniformGrid grid;
+    NeighbourList neighbours;
+    Broadphase broadphaseMode = Broadphase::NeighbourList;
+    ContactCache contacts;
+    ContactMode contactSolver = ContactMode::Off;
+    WallKernel kernel;
+    StepStats stats;
+    float stepScale;
+    uint64_t rngSeed;
+    CounterRng rng;
+    uint64_t steps = 0;
+
+    // Buffers per bal groeien net als de store zonder te kopieren; de overige
+    // houden hun capaciteit. Een stap zonder groei alloceert dus niets.
+    VirtualArray<float> prevX;
+    VirtualArray<float> prevY;
+    VirtualArray<uint32_t> wallHits;  // per stuk op offset begin geschreven
+    size_t hitCount = 0;
+    VirtualArray<size_t> chunkHitStart; // eerste spawnplek per stuk, plus het totaal
+
+    // Spawnrij: richtingen van de ballen die aan het eind van de stap erbij
+    // komen, uitgestelde van eerdere stappen vooraan. Als VirtualArray, want
+    // de rij kan stappen lang groeien terwijl het aantal ballen gelijk blijft.
+    VirtualArray<float> spawnVx;
+    VirtualArray<float> spawnVy;
+    size_t spawnQueued = 0;           // samen met de store nooit meer dan BALL_STORE_MAX_BALLS
+    uint64_t droppedSpawns = 0;
+    VirtualArray<float> spawnX;       // gevonden plek per bal in de rij
+    VirtualArray<float> spawnY;
+    SpawnPlacer placer;
+    SpawnPlacement spawnMode = SpawnPlacement::Search;
+
+    // Herordenen: volgorde, de oude arrays als kladruimte en de id-tabellen
+    BallOrder order;
+    BallStore reorderStore;
+    VirtualArray<uint32_t> ids;      // id per index
+    VirtualArray<uint32_t> idIndex;  // index per id
+    VirtualArray<uint32_t> reorderIds;
+    bool reorderEnabled = true;
+    uint64_t reorders = 0;
+    uint64_t lastReorderStep = 0;
+    float sortedLocality = 1.0f;     // locality direct na de laatste herordening
+};
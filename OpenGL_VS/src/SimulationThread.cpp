@@ -0,0 +1,215 @@
+#include "SimulationThread.h"
+#include "AllocationCounter.h"
+#include "FixedTimestep.h"
+#include "Globals.h"
+#include "Profiler.h"
+#include <cassert>
+#include <chrono>
+#include <iostream>
+
+double simClockSeconds() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+SimulationThread::SimulationThread(Simulation& simulation, EventSimulation& events, bool eventEngine, double hz,
+    SimCommandQueue& queue)
+    : sim(simulation), eventSim(events), eventDriven(eventEngine), simHz(hz), commands(queue) {
+}
+
+SimulationThread::~SimulationThread() {
+    stop();
+}
+
+void SimulationThread::start() {
+    if (thread.joinable()) return;
+    // Eerste snapshot nog op de aanroepende thread, zodat er direct iets te tekenen is
+    beginSnapshot();
+    publish(simClockSeconds(), 1.0 / simHz, 0, 0, 0.0f);
+    snapshots.acquire();
+
+    quitting.store(false, std::memory_order_release);
+    thread = std::thread(&SimulationThread::run, this);
+}
+
+void SimulationThread::stop() {
+    if (!thread.joinable()) return;
+    quitting.store(true, std::memory_order_release);
+    thread.join();
+}
+
+// De event-engine heeft geen vorige stap: from is de toestand voor advance().
+void SimulationThread::beginSnapshot() {
+    if (!eventDriven) return;
+    SimSnapshot& s = snapshots.back();
+    const BallStore& balls = eventSim.balls();
+    s.from.reserve(balls.size());
+    Span<const float> x = balls.x();
+    Span<const float> y = balls.y();
+    for (size_t i = 0; i < balls.size(); ++i)
+        s.from[i] = { x[i], y[i], static_cast<uint32_t>(i) };
+    fromCount = balls.size();
+}
+
+void SimulationThread::publish(double stateTime, double span, uint64_t pairTests, uint64_t collisions, float simMs) {
+    PROFILE_SCOPE("snapshot");
+    SimSnapshot& s = snapshots.back();
+    const BallStore& balls = eventDriven ? eventSim.balls() : sim.balls();
+    const size_t n = balls.size();
+    s.from.reserve(n);
+    s.to.reserve(n);
+
+    Span<const float> x = balls.x();
+    Span<const float> y = balls.y();
+    if (eventDriven) {
+        for (size_t i = 0; i < n; ++i)
+            s.to[i] = { x[i], y[i], static_cast<uint32_t>(i) };
+        // Ballen die tijdens advance() gespawnd zijn beginnen waar ze nu staan
+        for (size_t i = fromCount; i < n; ++i)
+            s.from[i] = s.to[i];
+    }
+    else {
+        for (size_t c = 0; c < balls.chunkCount(); ++c) {
+            BallRange range = balls.chunk(c);
+            sim.writeInstances(range, 0.0f, s.from.data() + range.begin);
+            for (size_t i = range.begin; i < range.end; ++i)
+                s.to[i] = { x[i], y[i], sim.ballId(i) };
+        }
+    }
+
+    s.count = n;
+    s.time = stateTime;
+    s.stepSeconds = span;
+    s.stepCount = stepCount;
+    s.simMs = simMs;
+    s.pairTests = pairTests;
+    s.collisions = collisions;
+    s.rebuilds = sim.neighbourRebuilds();
+    s.spawnsDropped = eventDriven ? eventSim.totals().spawnsDropped : sim.spawnsDropped();
+    s.phases = phases;
+    snapshots.publish();
+}
+
+// Tussen twee rondes stappen, dus op een stilstaande simulatie; het beeld
+// loopt intussen gewoon door op de laatste snapshot. true als de toestand
+// vervangen is (ook een mislukte load reset de simulatie).
+bool SimulationThread::runCheckpoint(bool load) {
+    if (eventDriven) {
+        std::cerr << "Checkpoints need the step engine" << std::endl;
+        return false;
+    }
+    double start = simClockSeconds();
+    std::string error;
+    bool ok = load ? sim.loadCheckpoint(checkpointPath, error) : sim.saveCheckpoint(checkpointPath, error);
+    double ms = (simClockSeconds() - start) * 1000.0;
+    if (!ok) {
+        std::cerr << (load ? "Loading" : "Saving") << " checkpoint failed: " << error << std::endl;
+        return load;
+    }
+    std::cout << (load ? "Loaded " : "Saved ") << sim.balls().size() << " balls at step " << sim.stepCount()
+        << (load ? " from " : " to ") << checkpointPath << " in " << ms << " ms" << std::endl;
+    return load;
+}
+
+void SimulationThread::run() {
+    FixedTimestep clock(simHz, MAX_STEPS_PER_FRAME);
+    double last = simClockSeconds();
+#ifdef BALLS_PROFILE
+    double lastSummaryTime = last;
+#endif
+#ifdef BALLS_COUNT_ALLOCS
+    // Zelfde controle als de GL-thread per frame, hier per ronde stappen
+    const uint64_t ALLOC_CHECK_WARMUP_ROUNDS = 10;
+    uint64_t rounds = 0;
+    size_t previousRoundBalls = 0;
+#endif
+
+    while (!quitting.load(std::memory_order_acquire)) {
+        SimCommand command;
+        bool reset = false;
+        bool checkpoint = false;
+        while (commands.pop(command)) {
+            if (command == SimCommand::TogglePause) {
+                running = !running;
+            }
+            else if (command == SimCommand::Reset) {
+                sim.reset();
+                eventSim.reset();
+                stepCount = 0;
+                reset = true;
+            }
+            else if (command == SimCommand::SaveCheckpoint || command == SimCommand::LoadCheckpoint) {
+                if (runCheckpoint(command == SimCommand::LoadCheckpoint)) reset = true;
+                checkpoint = true;
+            }
+        }
+        if (reset) {
+            beginSnapshot();
+            publish(simClockSeconds(), clock.stepSeconds(), 0, 0, 0.0f);
+        }
+        // De tijd voor het checkpoint hoeft niet ingehaald te worden
+        if (checkpoint) last = simClockSeconds();
+
+        double now = simClockSeconds();
+        double elapsed = now - last;
+        last = now;
+        int steps = running ? clock.advance(elapsed) : 0;
+        if (steps == 0) {
+            // Slapen tot de volgende stap; gepauzeerd telt de tijd niet mee
+            double wait = running ? (1.0 - clock.alpha()) * clock.stepSeconds() : clock.stepSeconds();
+            std::this_thread::sleep_for(std::chrono::duration<double>(wait));
+            continue;
+        }
+
+#ifdef BALLS_COUNT_ALLOCS
+        const uint64_t roundAllocStart = allocationCount();
+        const size_t roundBallsStart = eventDriven ? eventSim.balls().size() : sim.balls().size();
+#endif
+        uint64_t pairTests = 0;
+        uint64_t collisions = 0;
+        double span = clock.stepSeconds();
+        if (eventDriven) {
+            // Geen vaste stap: in een keer over de tijd van steps stappen
+            PROFILE_SCOPE("simulate");
+            beginSnapshot();
+            EventStats before = eventSim.totals();
+            eventSim.advance(steps * (SIM_REFERENCE_HZ / simHz));
+            pairTests = eventSim.totals().pairTests - before.pairTests;
+            collisions = eventSim.totals().collisions - before.collisions;
+            span = steps * clock.stepSeconds();
+        }
+        else {
+            PROFILE_SCOPE("simulate");
+            for (int s = 0; s < steps; ++s) {
+                sim.step();
+                if (recorder) recorder->record(sim);
+            }
+            pairTests = sim.lastStats().pairTests;
+            collisions = sim.lastStats().collisions;
+        }
+        stepCount += steps;
+        float simMs = static_cast<float>((simClockSeconds() - now) * 1000.0);
+
+        // De resterende accumulator is hoe ver de klok al voorbij de laatste stap is
+        publish(now - clock.alpha() * clock.stepSeconds(), span, pairTests, collisions, simMs);
+
+#ifdef BALLS_COUNT_ALLOCS
+        const size_t roundBallsEnd = eventDriven ? eventSim.balls().size() : sim.balls().size();
+        if (++rounds > ALLOC_CHECK_WARMUP_ROUNDS && roundBallsEnd == roundBallsStart &&
+            roundBallsStart == previousRoundBalls) {
+            const uint64_t roundAllocs = allocationCount() - roundAllocStart;
+            if (roundAllocs != 0)
+                std::cerr << "Simulation round " << rounds << ": " << roundAllocs << " heap allocations" << std::endl;
+            assert(roundAllocs == 0 && "heap allocation in steady-state simulation round");
+        }
+        previousRoundBalls = roundBallsStart;
+#endif
+
+#ifdef BALLS_PROFILE
+        // Gaat met de volgende snapshot mee; de StatsLog-writer schrijft het weg
+        if (now - lastSummaryTime >= 1.0) {
+            profilerPhases(phases);
+            lastSummaryTime = now;
+        }
+#endif
+    }
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include "Ball.h"
+#include "EventSimulation.h"
+#include "Profiler.h"
+#include "Simulation.h"
+#include "SpscQueue.h"
+#include "Trajectory.h"
+#include "TripleBuffer.h"
+#include "VirtualArray.h"
+
+// Opdrachten van de GL-thread (key_callback) aan de simulatiethread.
+enum class SimCommand : uint8_t {
+    TogglePause,
+    Reset,
+    SaveCheckpoint, // naar het pad van setCheckpointPath
+    LoadCheckpoint
+};
+
+typedef SpscQueue<SimCommand, 64> SimCommandQueue;
+
+// Seconden op de klok die beide threads delen (steady_clock).
+double simClockSeconds();
+
+// Toestand die de simulatiethread publiceert en de GL-thread alleen leest:
+// de posities aan het begin en eind van de laatste stap, met het id van elke
+// bal voor de kleur. from en to hebben evenveel ballen; nieuw gespawnde
+// ballen staan in from al op hun beginpositie.
+struct SimSnapshot {
+    VirtualArray<BallInstance> from;
+    VirtualArray<BallInstance> to;
+    size_t count = 0;
+    double time = 0.0;        // simClockSeconds() waarop to de actuele toestand is
+    double stepSeconds = 1.0; // tijd tussen from en to
+    uint64_t stepCount = 0;   // stappen sinds de start
+    float simMs = 0.0f;       // rekentijd van de laatste ronde stappen
+    uint64_t pairTests = 0;   // van de laatste ronde
+    uint64_t collisions = 0;
+    uint64_t rebuilds = 0;    // opbouw van de buurlijst sinds de start
+    uint64_t spawnsDropped = 0; // sinds de start, zie BALL_STORE_MAX_BALLS
+    ProfilePhases phases;     // met BALLS_PROFILE: fasen van de simulatiethread, elke seconde bijgewerkt
+
+    // Hoe ver now tussen from en to ligt, zoals FixedTimestep::alpha(): het
+    // beeld loopt een stap achter op de simulatie.
+    float alpha(double now) const {
+        double a = (now - time) / stepSeconds;
+        return static_cast<float>(a < 0.0 ? 0.0 : a > 1.0 ? 1.0 : a);
+    }
+};
+
+// Draait de simulatie op een eigen thread met een vaste stap op de echte
+// klok, los van de framerate: een zware botsingsstap houdt het beeld niet op
+// en wachten op vsync houdt de simulatie niet op. Na elke ronde stappen gaat
+// een snapshot via een TripleBuffer naar de GL-thread; opdrachten komen
+// andersom binnen via een SPSC-wachtrij. Geen van beide richtingen gebruikt
+// een lock.
+class SimulationThread {
+public:
+    // sim en eventSim blijven van de aanroeper, maar mogen tussen start() en
+    // stop() alleen door deze thread aangeraakt worden.
+    SimulationThread(Simulation& sim, EventSimulation& eventSim, bool eventDriven, double simHz,
+        SimCommandQueue& commands);
+    ~SimulationThread();
+
+    SimulationThread(const SimulationThread&) = delete;
+    SimulationThread& operator=(const SimulationThread&) = delete;
+
+    // Bestand voor SaveCheckpoint en LoadCheckpoint; voor start() zetten.
+    void setCheckpointPath(const std::string& path) { checkpointPath = path; }
+    // Krijgt elke stap van de step-engine; al gestart, voor start() zetten.
+    void setRecorder(TrajectoryRecorder* trajectory) { recorder = trajectory; }
+
+    void start();
+    void stop();
+
+    // GL-thread: haalt de nieuwste snapshot op; true als die nieuw is.
+    bool acquire() { return snapshots.acquire(); }
+    const SimSnapshot& snapshot() const { return snapshots.front(); }
+
+private:
+    void run();
+    void beginSnapshot();
+    bool runCheckpoint(bool load);
+    void publish(double stateTime, double span, uint64_t pairTests, uint64_t collisions, float simMs);
+
+    Simulation& sim;
+    EventSimulation& eventSim;
+    const bool eventDriven;
+    const double simHz;
+    SimCommandQueue& commands;
+    std::string checkpointPath;
+    TrajectoryRecorder* recorder = nullptr;
+
+    TripleBuffer<SimSnapshot> snapshots;
+    uint64_t stepCount = 0;
+    size_t fromCount = 0; // ballen in back().from, alleen voor de event-engine
+    ProfilePhases phases; // laatste profilerPhases() van deze thread
+    bool running = true;
+
+    std::thread thread;
+    std::atomic<bool> quitting{ false };
+};
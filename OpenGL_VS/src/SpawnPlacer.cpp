@@ -0,0 +1,127 @@
+#include "SpawnPlacer.h"
+#include "Globals.h"
+#include "Profiler.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cmath>
+
+// Het grid dekt het zoekgebied plus een diameter, zodat elke bal die een
+// kandidaat kan overlappen erin staat. Cellen zijn een diameter groot, dus
+// alleen de 3x3 naburige cellen tellen.
+constexpr float SPAWN_EXTENT = SPAWN_SEARCH_RADIUS + 2.0f * BALL_RADIUS;
+constexpr float SPAWN_CELL_SIZE = 2.0f * BALL_RADIUS;
+constexpr int SPAWN_GRID_DIM = static_cast<int>(2.0f * SPAWN_EXTENT / SPAWN_CELL_SIZE) + 1;
+constexpr uint32_t NO_BALL = 0xFFFFFFFFu;
+constexpr float GOLDEN_ANGLE = 2.39996323f;
+constexpr size_t SPAWN_SCAN_GRAIN = 16 * 1024;
+
+static bool inSpawnRegion(float x, float y) {
+    return std::fabs(x) < SPAWN_EXTENT && std::fabs(y) < SPAWN_EXTENT;
+}
+
+static int spawnCellCoord(float p) {
+    int c = static_cast<int>((p + SPAWN_EXTENT) / SPAWN_CELL_SIZE);
+    if (c < 0) return 0;
+    if (c >= SPAWN_GRID_DIM) return SPAWN_GRID_DIM - 1;
+    return c;
+}
+
+SpawnPlacer::SpawnPlacer() : cellHead(SPAWN_GRID_DIM * SPAWN_GRID_DIM, NO_BALL) {
+    // Vogel-spiraal: gelijkmatig verdeeld, SPAWN_SPIRAL_STEP bepaalt de dichtheid
+    for (int k = 0;; ++k) {
+        float r = SPAWN_SPIRAL_STEP * std::sqrt(static_cast<float>(k));
+        if (r > SPAWN_SEARCH_RADIUS) break;
+        float angle = k * GOLDEN_ANGLE;
+        candX.push_back(r * std::cos(angle));
+        candY.push_back(r * std::sin(angle));
+    }
+}
+
+void SpawnPlacer::prepare(const BallStore& balls, ThreadPool* pool) {
+    PROFILE_SCOPE("spawn search");
+    const size_t n = balls.size();
+    Span<const float> x = balls.x();
+    Span<const float> y = balls.y();
+
+    // Twee rondes zoals de wandhits: elk stuk telt, een prefix sum geeft elk
+    // stuk zijn plekken en dan schrijft elk stuk zijn ballen, in volgorde van index
+    const size_t chunks = (n + SPAWN_SCAN_GRAIN - 1) / SPAWN_SCAN_GRAIN;
+    chunkStart.reserve(chunks + 1);
+    chunkStart[0] = 0;
+    auto count = [&](size_t begin, size_t end, unsigned) {
+        size_t found = 0;
+        for (size_t i = begin; i < end; ++i)
+            found += inSpawnRegion(x[i], y[i]);
+        chunkStart[begin / SPAWN_SCAN_GRAIN + 1] = found;
+    };
+    if (pool) pool->parallelFor(n, SPAWN_SCAN_GRAIN, count);
+    else if (n) count(0, n, 0);
+    for (size_t c = 0; c < chunks; ++c)
+        chunkStart[c + 1] += chunkStart[c];
+
+    const size_t total = chunkStart[chunks];
+    px.reserve(total + candX.size());
+    py.reserve(total + candX.size());
+    nextInCell.reserve(total + candX.size());
+    auto gather = [&](size_t begin, size_t end, unsigned) {
+        size_t k = chunkStart[begin / SPAWN_SCAN_GRAIN];
+        for (size_t i = begin; i < end; ++i) {
+            if (!inSpawnRegion(x[i], y[i])) continue;
+            px[k] = x[i];
+            py[k] = y[i];
+            ++k;
+        }
+    };
+    if (pool) pool->parallelFor(n, SPAWN_SCAN_GRAIN, gather);
+    else if (n) gather(0, n, 0);
+
+    // Het grid zelf is klein en serieel
+    std::fill(cellHead.begin(), cellHead.end(), NO_BALL);
+    for (size_t b = 0; b < total; ++b)
+        link(static_cast<uint32_t>(b));
+    regionCount = total;
+    nextCandidate = 0;
+}
+
+void SpawnPlacer::link(uint32_t b) {
+    uint32_t cell = spawnCellCoord(py[b]) * SPAWN_GRID_DIM + spawnCellCoord(px[b]);
+    nextInCell[b] = cellHead[cell];
+    cellHead[cell] = b;
+}
+
+// De ruimte is er al sinds prepare()
+void SpawnPlacer::insert(float x, float y) {
+    px[regionCount] = x;
+    py[regionCount] = y;
+    link(static_cast<uint32_t>(regionCount++));
+}
+
+// Vrij betekent dat geen bal dichterbij is dan een diameter, dezelfde grens
+// als de narrowphase.
+bool SpawnPlacer::isFree(float x, float y) const {
+    int cx = spawnCellCoord(x);
+    int cy = spawnCellCoord(y);
+    for (int ny = cy - 1; ny <= cy + 1; ++ny) {
+        if (ny < 0 || ny >= SPAWN_GRID_DIM) continue;
+        for (int nx = cx - 1; nx <= cx + 1; ++nx) {
+            if (nx < 0 || nx >= SPAWN_GRID_DIM) continue;
+            for (uint32_t b = cellHead[ny * SPAWN_GRID_DIM + nx]; b != NO_BALL; b = nextInCell[b]) {
+                float dx = px[b] - x;
+                float dy = py[b] - y;
+                if (dx * dx + dy * dy < 4 * BALL_RADIUS * BALL_RADIUS) return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool SpawnPlacer::place(float& x, float& y) {
+    for (; nextCandidate < candX.size(); ++nextCandidate) {
+        if (!isFree(candX[nextCandidate], candY[nextCandidate])) continue;
+        x = candX[nextCandidate];
+        y = candY[nextCandidate];
+        insert(x, y);
+        return true;
+    }
+    return false;
+}
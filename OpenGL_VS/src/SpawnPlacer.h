@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "BallStore.h"
+#include "VirtualArray.h"
+
+class ThreadPool;
+
+// Zoekt voor nieuwe ballen een plek bij de oorsprong waar ze niets overlappen.
+// Alle ballen in de oorsprong zetten geeft na een reeks wandhits een stapel
+// ballen op precies hetzelfde punt; resolveBallCollision kan die niet uit
+// elkaar halen (dist == 0) en de cel wordt een O(k^2) hotspot.
+//
+// De kandidaten liggen op een vaste spiraal (Vogel) vanaf de oorsprong tot
+// SPAWN_SEARCH_RADIUS; de eerste vrije wint. prepare() zet de ballen rond de
+// oorsprong in een klein eigen grid, place() voegt elke geplaatste bal daaraan
+// toe. Binnen een stap raken kandidaten alleen voller, dus de zoektocht gaat
+// verder waar de vorige bal een vrije plek vond. place() voegt hooguit een
+// bal per kandidaat toe, dus prepare() reserveert daar meteen ruimte voor en
+// een stap alloceert niets.
+class SpawnPlacer {
+public:
+    SpawnPlacer();
+
+    // Voor de eerste place() van een stap, met de posities na de botsingen.
+    // Met een pool zoeken de stukken parallel naar ballen in het zoekgebied.
+    void prepare(const BallStore& balls, ThreadPool* pool = nullptr);
+
+    // Eerste vrije kandidaat in x, y; false als het hele zoekgebied vol zit.
+    bool place(float& x, float& y);
+
+    size_t candidateCount() const { return candX.size(); }
+
+private:
+    void insert(float x, float y);
+    void link(uint32_t b);
+    bool isFree(float x, float y) const;
+
+    std::vector<float> candX;      // spiraal, van binnen naar buiten
+    std::vector<float> candY;
+    size_t nextCandidate = 0;      // kandidaten ervoor zijn al bezet
+
+    VirtualArray<float> px;        // ballen in het zoekgebied
+    VirtualArray<float> py;
+    VirtualArray<uint32_t> nextInCell;
+    size_t regionCount = 0;        // gebruikt van px, py en nextInCell
+    VirtualArray<size_t> chunkStart; // eerste plek in px per stuk, plus het totaal
+    std::vector<uint32_t> cellHead;
+};
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+// Begrensde lock-free wachtrij voor precies een schrijvende en een lezende
+// thread. head wordt alleen door push() geschreven en tail alleen door pop(),
+// dus elke kant heeft genoeg aan een acquire-load van de teller van de ander.
+template <typename T, size_t N>
+class SpscQueue {
+public:
+    static_assert(N > 0 && (N & (N - 1)) == 0, "N moet een macht van twee zijn");
+
+    // Alleen vanuit de schrijvende thread. false als de wachtrij vol is.
+    bool push(const T& value) {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) == N) return false;
+        items[h & (N - 1)] = value;
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Alleen vanuit de lezende thread. false als de wachtrij leeg is.
+    bool pop(T& value) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t == head.load(std::memory_order_acquire)) return false;
+        value = items[t & (N - 1)];
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    T items[N];
+    alignas(64) std::atomic<size_t> head{ 0 };
+    alignas(64) std::atomic<size_t> tail{ 0 };
+};
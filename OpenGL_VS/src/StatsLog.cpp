@@ -0,0 +1,112 @@
+#include "StatsLog.h"
+#include <chrono>
+#include <cstring>
+
+bool parseStatsFormat(const char* name, StatsFormat& format) {
+    if (std::strcmp(name, "text") == 0) format = StatsFormat::Text;
+    else if (std::strcmp(name, "json") == 0) format = StatsFormat::JsonLines;
+    else return false;
+    return true;
+}
+
+StatsLog::~StatsLog() {
+    stop();
+}
+
+void StatsLog::start(FILE* file, StatsFormat fmt, double hz) {
+    stop();
+    if (!file || hz <= 0.0) return;
+
+    out = file;
+    format = fmt;
+    periodSeconds = 1.0 / hz;
+    stopping = false;
+    writer = std::thread(&StatsLog::writerLoop, this);
+}
+
+void StatsLog::stop() {
+    if (!writer.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(stopMutex);
+        stopping = true;
+    }
+    stopSignal.notify_all();
+    writer.join();
+}
+
+void StatsLog::push(const StatsSample& sample) {
+    if (!writer.joinable()) return;
+
+    size_t h = head.load(std::memory_order_relaxed);
+    size_t t = tail.load(std::memory_order_acquire);
+    if (h - t == RING_SIZE) {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    ring[h % RING_SIZE] = sample;
+    head.store(h + 1, std::memory_order_release);
+}
+
+void StatsLog::writerLoop() {
+    const std::chrono::duration<double> period(periodSeconds);
+    bool done = false;
+    while (!done) {
+        {
+            std::unique_lock<std::mutex> lock(stopMutex);
+            done = stopSignal.wait_for(lock, period, [this] { return stopping; });
+        }
+
+        size_t t = tail.load(std::memory_order_relaxed);
+        size_t h = head.load(std::memory_order_acquire);
+        if (t == h) continue;
+
+        StatsSample latest = ring[(h - 1) % RING_SIZE];
+        tail.store(h, std::memory_order_release);
+        write(latest, h - t);
+    }
+}
+
+// Een regel per thread, zoals "Sim: step 1.234ms  collide 0.456ms"
+void StatsLog::writePhasesText(const char* label, const ProfilePhases& phases) {
+    if (!phases.count) return;
+    std::fprintf(out, "%s:", label);
+    for (uint32_t p = 0; p < phases.count; ++p)
+        std::fprintf(out, "%s%s %.3fms", p ? "  " : " ", phases.phase[p].name, phases.phase[p].ms);
+    std::fputc('\n', out);
+}
+
+void StatsLog::writePhasesJson(const char* key, const ProfilePhases& phases) {
+    if (!phases.count) return;
+    std::fprintf(out, ",\"%s\":{", key);
+    for (uint32_t p = 0; p < phases.count; ++p)
+        std::fprintf(out, "%s\"%s\":%.3f", p ? "," : "", phases.phase[p].name, phases.phase[p].ms);
+    std::fputc('}', out);
+}
+
+void StatsLog::write(const StatsSample& s, uint64_t framesSinceLast) {
+    if (format == StatsFormat::JsonLines) {
+        std::fprintf(out,
+            "{\"t\":%.3f,\"frame\":%llu,\"balls\":%llu,\"fps\":%.1f,\"frame_ms\":%.3f,"
+            "\"sim_ms\":%.3f,\"draw_ms\":%.3f,\"steps\":%u,\"pair_tests\":%llu,"
+            "\"collisions\":%llu,\"rebuilds\":%llu,\"spawns_dropped\":%llu,\"frames\":%llu,\"dropped\":%llu",
+            s.time, static_cast<unsigned long long>(s.frame), static_cast<unsigned long long>(s.balls),
+            s.fps, s.frameMs, s.simMs, s.drawMs, s.steps,
+            static_cast<unsigned long long>(s.pairTests), static_cast<unsigned long long>(s.collisions),
+            static_cast<unsigned long long>(s.rebuilds), static_cast<unsigned long long>(s.spawnsDropped),
+            static_cast<unsigned long long>(framesSinceLast),
+            static_cast<unsigned long long>(dropped.load(std::memory_order_relaxed)));
+        writePhasesJson("render_phases_ms", s.renderPhases);
+        writePhasesJson("sim_phases_ms", s.simPhases);
+        std::fputs("}\n", out);
+    }
+    else {
+        std::fprintf(out, "Ball count: %llu  fps: %.1f  frame: %.2f ms  sim: %.2f ms  draw: %.2f ms  collisions: %llu  rebuilds: %llu\n",
+            static_cast<unsigned long long>(s.balls), s.fps, s.frameMs, s.simMs, s.drawMs,
+            static_cast<unsigned long long>(s.collisions), static_cast<unsigned long long>(s.rebuilds));
+        if (s.spawnsDropped)
+            std::fprintf(out, "Ball limit reached: %llu spawns dropped\n", static_cast<unsigned long long>(s.spawnsDropped));
+        writePhasesText("Render", s.renderPhases);
+        writePhasesText("Sim", s.simPhases);
+    }
+    std::fflush(out);
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include "Profiler.h"
+
+// Tellers van een frame.
+struct StatsSample {
+    double time = 0.0;      // seconden sinds de start
+    uint64_t frame = 0;
+    uint64_t balls = 0;
+    float fps = 0.0f;
+    float frameMs = 0.0f;
+    float simMs = 0.0f;
+    float drawMs = 0.0f;
+    uint32_t steps = 0;     // simulatiestappen in deze frame
+    uint64_t pairTests = 0; // van de laatste stap
+    uint64_t collisions = 0;
+    uint64_t rebuilds = 0;  // opbouw van de buurlijst sinds de start
+    uint64_t spawnsDropped = 0; // sinds de start, zie BALL_STORE_MAX_BALLS
+    // Met BALLS_PROFILE: gemiddelde per fase over de laatste seconde, van de
+    // renderthread en van de simulatiethread (via de snapshot)
+    ProfilePhases renderPhases;
+    ProfilePhases simPhases;
+};
+
+enum class StatsFormat {
+    Text,
+    JsonLines
+};
+
+// De renderthread zet elke frame een sample in een lock-free SPSC-ring;
+// een achtergrondthread leegt de ring en schrijft met een vaste frequentie
+// alleen het laatste sample weg. Zo kost loggen de frame geen I/O.
+class StatsLog {
+public:
+    StatsLog() = default;
+    ~StatsLog();
+
+    StatsLog(const StatsLog&) = delete;
+    StatsLog& operator=(const StatsLog&) = delete;
+
+    // out wordt niet gesloten door StatsLog. hz <= 0 zet het loggen uit.
+    void start(FILE* out, StatsFormat format, double hz);
+    void stop();
+
+    // Alleen vanuit een thread aanroepen. Bij een volle ring valt het sample weg.
+    void push(const StatsSample& sample);
+
+private:
+    static const size_t RING_SIZE = 256;
+
+    void writerLoop();
+    void write(const StatsSample& sample, uint64_t framesSinceLast);
+    void writePhasesText(const char* label, const ProfilePhases& phases);
+    void writePhasesJson(const char* key, const ProfilePhases& phases);
+
+    StatsSample ring[RING_SIZE];
+    std::atomic<size_t> head{ 0 }; // alleen geschreven door push()
+    std::atomic<size_t> tail{ 0 }; // alleen geschreven door de writer
+    std::atomic<uint64_t> dropped{ 0 };
+
+    FILE* out = nullptr;
+    StatsFormat format = StatsFormat::Text;
+    double periodSeconds = 1.0;
+
+    std::thread writer;
+    std::mutex stopMutex;
+    std::condition_variable stopSignal;
+    bool stopping = false;
+};
+
+bool parseStatsFormat(const char* name, StatsFormat& format);
@@ -0,0 +1,125 @@
+#include "StreamBuffer.h"
+#include <GLFW/glfw3.h>
+#include <cstring>
+
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#endif
+#ifndef GL_MAP_COHERENT_BIT
+#define GL_MAP_COHERENT_BIT 0x0080
+#endif
+
+// glad is gegenereerd voor GL 3.3 en kent glBufferStorage niet
+typedef void (APIENTRYP PFNBUFFERSTORAGEPROC)(GLenum target, GLsizeiptr size, const void* data, GLbitfield flags);
+static PFNBUFFERSTORAGEPROC bufferStorage = nullptr;
+
+constexpr size_t MIN_REGION_SIZE = 64 * 1024;
+
+static bool hasBufferStorage() {
+    GLint major = 0, minor = 0;
+    glGetIntegerv(GL_MAJOR_VERSION, &major);
+    glGetIntegerv(GL_MINOR_VERSION, &minor);
+    bool supported = major > 4 || (major == 4 && minor >= 4);
+
+    GLint extensionCount = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &extensionCount);
+    for (GLint i = 0; i < extensionCount && !supported; ++i) {
+        const char* name = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
+        if (name && std::strcmp(name, "GL_ARB_buffer_storage") == 0)
+            supported = true;
+    }
+    if (!supported) return false;
+
+    bufferStorage = reinterpret_cast<PFNBUFFERSTORAGEPROC>(glfwGetProcAddress("glBufferStorage"));
+    return bufferStorage != nullptr;
+}
+
+void StreamBuffer::create(GLenum bufferTarget) {
+    target = bufferTarget;
+    persistentMapped = hasBufferStorage();
+    allocate(MIN_REGION_SIZE);
+}
+
+void StreamBuffer::destroy() {
+    for (GLsync& f : fences) {
+        if (f) glDeleteSync(f);
+        f = nullptr;
+    }
+    if (id) {
+        if (mapped) {
+            glBindBuffer(target, id);
+            glUnmapBuffer(target);
+        }
+        glDeleteBuffers(1, &id);
+    }
+    id = 0;
+    mapped = nullptr;
+    regionSize = 0;
+}
+
+void StreamBuffer::allocate(size_t bytes) {
+    size_t size = MIN_REGION_SIZE;
+    while (size < bytes) size *= 2;
+
+    if (persistentMapped) {
+        // Immutable storage kan niet groeien: alle regio's afwachten en opnieuw beginnen
+        for (int r = 0; r < STREAM_REGIONS; ++r)
+            waitForRegion(r);
+        destroy();
+
+        const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glGenBuffers(1, &id);
+        glBindBuffer(target, id);
+        bufferStorage(target, static_cast<GLsizeiptr>(size * STREAM_REGIONS), nullptr, flags);
+        mapped = static_cast<char*>(glMapBufferRange(target, 0, static_cast<GLsizeiptr>(size * STREAM_REGIONS), flags));
+        region = 0;
+
+        if (!mapped) {
+            glDeleteBuffers(1, &id);
+            id = 0;
+            persistentMapped = false;
+        }
+    }
+    if (!persistentMapped) {
+        if (!id) glGenBuffers(1, &id);
+        glBindBuffer(target, id);
+        glBufferData(target, static_cast<GLsizeiptr>(size), nullptr, GL_STREAM_DRAW);
+    }
+    regionSize = size;
+}
+
+void StreamBuffer::waitForRegion(int r) {
+    if (!fences[r]) return;
+    GLenum result = glClientWaitSync(fences[r], 0, 0);
+    while (result == GL_TIMEOUT_EXPIRED)
+        result = glClientWaitSync(fences[r], GL_SYNC_FLUSH_COMMANDS_BIT, 1000000); // 1 ms
+    glDeleteSync(fences[r]);
+    fences[r] = nullptr;
+}
+
+void* StreamBuffer::map(size_t bytes) {
+    if (bytes > regionSize)
+        allocate(bytes);
+
+    glBindBuffer(target, id);
+    if (persistentMapped) {
+        waitForRegion(region);
+        return mapped + region * regionSize;
+    }
+    return glMapBufferRange(target, 0, static_cast<GLsizeiptr>(bytes), GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+}
+
+size_t StreamBuffer::unmap() {
+    if (persistentMapped)
+        return region * regionSize;
+
+    glBindBuffer(target, id);
+    glUnmapBuffer(target);
+    return 0;
+}
+
+void StreamBuffer::fence() {
+    if (!persistentMapped) return;
+    fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    region = (region + 1) % STREAM_REGIONS;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <glad/glad.h>
+
+// Buffer voor data die elke frame opnieuw geschreven wordt.
+//
+// Met ARB_buffer_storage (of GL 4.4) is de buffer persistent en coherent
+// gemapt en verdeeld in STREAM_REGIONS regio's: de CPU schrijft frame N+2
+// terwijl de GPU nog frame N leest, en een fence per regio voorkomt dat een
+// regio overschreven wordt voordat de GPU klaar is. Op een kale 3.3 context
+// valt hij terug op orphaning met glMapBufferRange en
+// GL_MAP_INVALIDATE_BUFFER_BIT.
+//
+// Gebruik per frame: map(bytes), schrijven, unmap() (geeft de byte-offset
+// van de geschreven data in buffer()), draw call, fence().
+class StreamBuffer {
+public:
+    static const int STREAM_REGIONS = 3;
+
+    void create(GLenum target);
+    void destroy();
+
+    void* map(size_t bytes);
+    size_t unmap();
+    void fence();
+
+    GLuint buffer() const { return id; }
+    bool persistent() const { return persistentMapped; }
+
+private:
+    void allocate(size_t bytes);
+    void waitForRegion(int r);
+
+    GLenum target = GL_ARRAY_BUFFER;
+    GLuint id = 0;
+    bool persistentMapped = false;
+
+    size_t regionSize = 0;
+    int region = 0;
+    char* mapped = nullptr;
+    GLsync fences[STREAM_REGIONS] = {};
+};
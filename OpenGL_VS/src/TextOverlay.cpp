@@ -0,0 +1,186 @@
+#include "TextOverlay.h"
+#include "Utils.h"
+#include <cctype>
+#include <cstring>
+
+// Tekens in de atlas, in volgorde; onbekende tekens worden een spatie.
+static const char GLYPH_CHARS[] = " 0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ.:-/";
+constexpr int GLYPH_COUNT = sizeof(GLYPH_CHARS) - 1;
+constexpr int GLYPH_CELL = 8;   // pixels per cel in de atlas
+constexpr int GLYPH_SCALE = 2;  // schermpixels per fontpixel
+
+// 5x7 font, een byte per rij, bit 4 is de linker kolom.
+static const unsigned char GLYPH_ROWS[GLYPH_COUNT][7] = {
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // spatie
+    { 0x0E, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0E }, // 0
+    { 0x04, 0x0C, 0x04, 0x04, 0x04, 0x04, 0x0E }, // 1
+    { 0x0E, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1F }, // 2
+    { 0x1F, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0E }, // 3
+    { 0x02, 0x06, 0x0A, 0x12, 0x1F, 0x02, 0x02 }, // 4
+    { 0x1F, 0x10, 0x1E, 0x01, 0x01, 0x11, 0x0E }, // 5
+    { 0x06, 0x08, 0x10, 0x1E, 0x11, 0x11, 0x0E }, // 6
+    { 0x1F, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08 }, // 7
+    { 0x0E, 0x11, 0x11, 0x0E, 0x11, 0x11, 0x0E }, // 8
+    { 0x0E, 0x11, 0x11, 0x0F, 0x01, 0x02, 0x0C }, // 9
+    { 0x0E, 0x11, 0x11, 0x11, 0x1F, 0x11, 0x11 }, // A
+    { 0x1E, 0x11, 0x11, 0x1E, 0x11, 0x11, 0x1E }, // B
+    { 0x0E, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0E }, // C
+    { 0x1C, 0x12, 0x11, 0x11, 0x11, 0x12, 0x1C }, // D
+    { 0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x1F }, // E
+    { 0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x10 }, // F
+    { 0x0E, 0x11, 0x10, 0x17, 0x11, 0x11, 0x0F }, // G
+    { 0x11, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11 }, // H
+    { 0x0E, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0E }, // I
+    { 0x07, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0C }, // J
+    { 0x11, 0x12, 0x14, 0x18, 0x14, 0x12, 0x11 }, // K
+    { 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1F }, // L
+    { 0x11, 0x1B, 0x15, 0x15, 0x11, 0x11, 0x11 }, // M
+    { 0x11, 0x11, 0x19, 0x15, 0x13, 0x11, 0x11 }, // N
+    { 0x0E, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E }, // O
+    { 0x1E, 0x11, 0x11, 0x1E, 0x10, 0x10, 0x10 }, // P
+    { 0x0E, 0x11, 0x11, 0x11, 0x15, 0x12, 0x0D }, // Q
+    { 0x1E, 0x11, 0x11, 0x1E, 0x14, 0x12, 0x11 }, // R
+    { 0x0F, 0x10, 0x10, 0x0E, 0x01, 0x01, 0x1E }, // S
+    { 0x1F, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04 }, // T
+    { 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E }, // U
+    { 0x11, 0x11, 0x11, 0x11, 0x11, 0x0A, 0x04 }, // V
+    { 0x11, 0x11, 0x11, 0x15, 0x15, 0x15, 0x0A }, // W
+    { 0x11, 0x11, 0x0A, 0x04, 0x0A, 0x11, 0x11 }, // X
+    { 0x11, 0x11, 0x11, 0x0A, 0x04, 0x04, 0x04 }, // Y
+    { 0x1F, 0x01, 0x02, 0x04, 0x08, 0x10, 0x1F }, // Z
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C }, // .
+    { 0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x0C, 0x00 }, // :
+    { 0x00, 0x00, 0x00, 0x1F, 0x00, 0x00, 0x00 }, // -
+    { 0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x00 }, // /
+};
+
+static const char* overlayVertexShaderSource = R"(
+    #version 330 core
+    layout (location = 0) in vec2 aCorner;
+    layout (location = 1) in vec3 aGlyph; // x, y in pixels, glyph-index
+    uniform vec2 screen;
+    out vec2 UV;
+    void main() {
+        const float cell = 8.0;
+        const float scale = 2.0;
+        const float count = 41.0;
+        vec2 pixel = aGlyph.xy + aCorner * cell * scale;
+        UV = vec2((aGlyph.z + aCorner.x) / count, aCorner.y);
+        gl_Position = vec4(pixel.x / screen.x * 2.0 - 1.0, 1.0 - pixel.y / screen.y * 2.0, 0.0, 1.0);
+    }
+)";
+
+static const char* overlayFragmentShaderSource = R"(
+    #version 330 core
+    in vec2 UV;
+    out vec4 FragColor;
+    uniform sampler2D atlas;
+    void main() {
+        if (texture(atlas, UV).r < 0.5) discard;
+        FragColor = vec4(0.9, 0.9, 0.9, 1.0);
+    }
+)";
+
+static int glyphIndex(char c) {
+    c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+    const char* p = std::strchr(GLYPH_CHARS, c);
+    return p && c ? static_cast<int>(p - GLYPH_CHARS) : 0;
+}
+
+TextOverlay::TextOverlay() {
+    static_assert(GLYPH_COUNT == 41, "shader gaat uit van 41 glyphs");
+    static_assert(GLYPH_CELL * GLYPH_SCALE == 16, "shader gaat uit van 8x8 cellen op schaal 2");
+
+    GLuint vertexShader = compileShader(GL_VERTEX_SHADER, overlayVertexShaderSource);
+    GLuint fragmentShader = compileShader(GL_FRAGMENT_SHADER, overlayFragmentShaderSource);
+    program = glCreateProgram();
+    glAttachShader(program, vertexShader);
+    glAttachShader(program, fragmentShader);
+    glLinkProgram(program);
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
+    screenLoc = glGetUniformLocation(program, "screen");
+
+    // Ruimte voor een paar regels, zodat tekenen daarna niet meer alloceert
+    glyphs.reserve(3 * 256);
+
+    // Atlas: een rij cellen van 8x8, het font linksboven in elke cel
+    std::vector<unsigned char> pixels(GLYPH_COUNT * GLYPH_CELL * GLYPH_CELL, 0);
+    const int atlasWidth = GLYPH_COUNT * GLYPH_CELL;
+    for (int g = 0; g < GLYPH_COUNT; ++g)
+        for (int row = 0; row < 7; ++row)
+            for (int col = 0; col < 5; ++col)
+                if (GLYPH_ROWS[g][row] & (0x10 >> col))
+                    pixels[row * atlasWidth + g * GLYPH_CELL + col] = 255;
+
+    glGenTextures(1, &atlas);
+    glBindTexture(GL_TEXTURE_2D, atlas);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, atlasWidth, GLYPH_CELL, 0, GL_RED, GL_UNSIGNED_BYTE, pixels.data());
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    const float corners[] = { 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f };
+    glGenVertexArrays(1, &vao);
+    glGenBuffers(1, &quadVBO);
+    glGenBuffers(1, &glyphVBO);
+    glBindVertexArray(vao);
+
+    glBindBuffer(GL_ARRAY_BUFFER, quadVBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(corners), corners, GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+
+    glBindBuffer(GL_ARRAY_BUFFER, glyphVBO);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(1);
+    glVertexAttribDivisor(1, 1);
+
+    glBindVertexArray(0);
+}
+
+void TextOverlay::destroy() {
+    glDeleteBuffers(1, &glyphVBO);
+    glDeleteBuffers(1, &quadVBO);
+    glDeleteVertexArrays(1, &vao);
+    glDeleteTextures(1, &atlas);
+    glDeleteProgram(program);
+    glyphVBO = quadVBO = vao = atlas = program = 0;
+}
+
+void TextOverlay::draw(const char* text, int framebufferWidth, int framebufferHeight) {
+    const float advance = 6.0f * GLYPH_SCALE;
+    const float lineHeight = 9.0f * GLYPH_SCALE;
+    float x = 8.0f;
+    float y = 8.0f;
+
+    glyphs.clear();
+    for (const char* p = text; *p; ++p) {
+        char c = *p;
+        if (c == '\n') {
+            x = 8.0f;
+            y += lineHeight;
+            continue;
+        }
+        int g = glyphIndex(c);
+        if (g != 0) {
+            glyphs.push_back(x);
+            glyphs.push_back(y);
+            glyphs.push_back(static_cast<float>(g));
+        }
+        x += advance;
+    }
+    if (glyphs.empty()) return;
+
+    glUseProgram(program);
+    glUniform2f(screenLoc, static_cast<float>(framebufferWidth), static_cast<float>(framebufferHeight));
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, atlas);
+    glBindVertexArray(vao);
+
+    glBindBuffer(GL_ARRAY_BUFFER, glyphVBO);
+    glBufferData(GL_ARRAY_BUFFER, glyphs.size() * sizeof(float), glyphs.data(), GL_STREAM_DRAW);
+    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, static_cast<GLsizei>(glyphs.size() / 3));
+}
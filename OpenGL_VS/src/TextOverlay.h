@@ -0,0 +1,31 @@
+#pragma once
+
+#include <vector>
+#include <glad/glad.h>
+
+// Tekent een paar regels tekst linksboven in beeld. De glyphs komen uit een
+// ingebouwd 5x7 bitmapfont dat bij het aanmaken in een atlas-texture gezet
+// wordt; een regel tekst is een enkele instanced draw call.
+class TextOverlay {
+public:
+    TextOverlay();
+
+    // Geeft de GL-objecten vrij; aanroepen zolang de context nog bestaat.
+    void destroy();
+
+    TextOverlay(const TextOverlay&) = delete;
+    TextOverlay& operator=(const TextOverlay&) = delete;
+
+    // text is nul-getermineerd; '\n' begint een nieuwe regel.
+    void draw(const char* text, int framebufferWidth, int framebufferHeight);
+
+private:
+    GLuint program = 0;
+    GLuint vao = 0;
+    GLuint quadVBO = 0;
+    GLuint glyphVBO = 0;
+    GLuint atlas = 0;
+    GLint screenLoc = -1;
+
+    std::vector<float> glyphs; // x, y, glyph-index per teken
+};
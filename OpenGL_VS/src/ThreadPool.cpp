@@ -0,0 +1,111 @@
+#include "ThreadPool.h"
+#include "Profiler.h"
+
+unsigned defaultThreadCount() {
+    unsigned n = std::thread::hardware_concurrency();
+    return n ? n : 1;
+}
+
+ThreadPool::ThreadPool(unsigned threadCount) {
+    if (threadCount == 0) threadCount = 1;
+    for (unsigned i = 0; i < threadCount; ++i)
+        queues.push_back(std::unique_ptr<WorkQueue>(new WorkQueue()));
+    for (unsigned i = 1; i < threadCount; ++i)
+        threads.emplace_back(&ThreadPool::workerLoop, this, i);
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread& t : threads)
+        t.join();
+}
+
+void ThreadPool::parallelFor(size_t n, size_t grain, const RangeFn& fn) {
+    if (n == 0) return;
+    if (grain == 0) grain = 1;
+
+    size_t chunks = (n + grain - 1) / grain;
+    if (chunks == 1 || queues.size() == 1) {
+        for (size_t begin = 0; begin < n; begin += grain)
+            fn(begin, begin + grain < n ? begin + grain : n, 0);
+        return;
+    }
+
+    // Eerst de teller zetten: een worker die nog uit de vorige ronde aan het
+    // zoeken is kan een nieuw stuk oppakken zodra het in een rij staat.
+    pending.store(chunks, std::memory_order_relaxed);
+
+    // Stukken round-robin over de rijen verdelen
+    for (size_t c = 0; c < chunks; ++c) {
+        size_t begin = c * grain;
+        size_t end = begin + grain < n ? begin + grain : n;
+        WorkQueue& q = *queues[c % queues.size()];
+        std::lock_guard<std::mutex> lock(q.mutex);
+        q.tasks.push_back({ &fn, begin, end });
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        ++generation;
+    }
+    wake.notify_all();
+
+    runTasks(0);
+    while (pending.load(std::memory_order_acquire) != 0)
+        std::this_thread::yield();
+}
+
+bool ThreadPool::popOrSteal(unsigned worker, Task& task) {
+    {
+        WorkQueue& own = *queues[worker];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (own.head < own.tasks.size()) {
+            task = own.tasks.back();
+            own.tasks.pop_back();
+            if (own.head == own.tasks.size()) {
+                own.tasks.clear();
+                own.head = 0;
+            }
+            return true;
+        }
+    }
+    for (size_t k = 1; k < queues.size(); ++k) {
+        WorkQueue& victim = *queues[(worker + k) % queues.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (victim.head < victim.tasks.size()) {
+            task = victim.tasks[victim.head++];
+            if (victim.head == victim.tasks.size()) {
+                victim.tasks.clear();
+                victim.head = 0;
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::runTasks(unsigned worker) {
+    Task task;
+    while (popOrSteal(worker, task)) {
+        PROFILE_SCOPE("task");
+        (*task.fn)(task.begin, task.end, worker);
+        pending.fetch_sub(1, std::memory_order_release);
+    }
+}
+
+void ThreadPool::workerLoop(unsigned worker) {
+    uint64_t seen = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(wakeMutex);
+            wake.wait(lock, [&] { return stopping || generation != seen; });
+            if (stopping) return;
+            seen = generation;
+        }
+        runTasks(worker);
+    }
+}
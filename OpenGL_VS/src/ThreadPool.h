@@ -0,0 +1,80 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Thread pool met een takenrij per worker. De eigenaar pakt taken van de
+// achterkant, workers zonder werk stelen van de voorkant van een ander.
+// De aanroepende thread doet zelf mee als worker 0.
+class ThreadPool {
+public:
+    // fn(begin, end, worker) verwerkt het bereik [begin, end). Niet-bezittende
+    // verwijzing naar de callable: anders dan std::function alloceert dit nooit,
+    // hoe groot de capture van een lambda ook is.
+    class RangeFn {
+    public:
+        template <typename F>
+        RangeFn(const F& f) : object(&f), call(&invoke<F>) {}
+        void operator()(size_t begin, size_t end, unsigned worker) const { call(object, begin, end, worker); }
+
+    private:
+        template <typename F>
+        static void invoke(const void* f, size_t begin, size_t end, unsigned worker) {
+            (*static_cast<const F*>(f))(begin, end, worker);
+        }
+
+        const void* object;
+        void (*call)(const void*, size_t, size_t, unsigned);
+    };
+
+    explicit ThreadPool(unsigned threads);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    unsigned threadCount() const { return static_cast<unsigned>(queues.size()); }
+
+    // Splitst [0, n) in stukken van grain elementen en blokkeert tot alles klaar
+    // is. Niet herintreedbaar: fn mag zelf geen parallelFor aanroepen.
+    void parallelFor(size_t n, size_t grain, const RangeFn& fn);
+
+private:
+    struct Task {
+        const RangeFn* fn;
+        size_t begin;
+        size_t end;
+    };
+
+    // Stelen schuift head op in plaats van de vector te verkleinen; een lege rij
+    // begint weer vooraan. De capaciteit blijft staan, dus een parallelFor van
+    // dezelfde grootte alloceert niets.
+    struct WorkQueue {
+        std::mutex mutex;
+        std::vector<Task> tasks;
+        size_t head = 0;
+    };
+
+    bool popOrSteal(unsigned worker, Task& task);
+    void runTasks(unsigned worker);
+    void workerLoop(unsigned worker);
+
+    std::vector<std::unique_ptr<WorkQueue>> queues;
+    std::vector<std::thread> threads;
+
+    std::mutex wakeMutex;
+    std::condition_variable wake;
+    uint64_t generation = 0;
+    bool stopping = false;
+
+    std::atomic<size_t> pending{ 0 };
+};
+
+// Standaard aantal threads: alle hardware threads, minimaal een.
+unsigned defaultThreadCount();
@@ -0,0 +1,302 @@
+#include "Trajectory.h"
+#include "Simulation.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+static const char TRAJECTORY_MAGIC[8] = { 'B', 'A', 'L', 'L', 'T', 'R', 'A', 'J' };
+constexpr size_t TRAJECTORY_HEADER_BYTES = sizeof(TRAJECTORY_MAGIC) + 4 * 4;
+
+enum TrajectoryFrameType : uint8_t {
+    TRAJECTORY_KEYFRAME = 0,
+    TRAJECTORY_DELTA = 1
+};
+
+// Zonder wachtende frames kijkt de writer zo vaak; record() wekt hem niet
+// zelf, want dat zou een lock op de simulatiethread betekenen.
+constexpr std::chrono::milliseconds TRAJECTORY_WRITER_PERIOD(2);
+
+static inline int16_t quantize(float v, float scale) {
+    float q = v * scale;
+    if (q > TRAJECTORY_SCALE) q = TRAJECTORY_SCALE;
+    if (q < -TRAJECTORY_SCALE) q = -TRAJECTORY_SCALE;
+    return static_cast<int16_t>(q < 0.0f ? q - 0.5f : q + 0.5f);
+}
+
+// Kleine verschillen, positief of negatief, worden kleine getallen
+static inline uint32_t zigzag(int32_t v) {
+    return (static_cast<uint32_t>(v) << 1) ^ static_cast<uint32_t>(v >> 31);
+}
+
+static inline int32_t unzigzag(uint32_t v) {
+    return static_cast<int32_t>(v >> 1) ^ -static_cast<int32_t>(v & 1);
+}
+
+static inline void putVarint(std::vector<uint8_t>& out, uint64_t v) {
+    while (v >= 0x80) {
+        out.push_back(static_cast<uint8_t>(v | 0x80));
+        v >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(v));
+}
+
+static void putU32(uint8_t* p, uint32_t v) {
+    for (int k = 0; k < 4; ++k) p[k] = static_cast<uint8_t>(v >> (8 * k));
+}
+
+static void putF32(uint8_t* p, float v) {
+    uint32_t bits;
+    std::memcpy(&bits, &v, sizeof(bits));
+    putU32(p, bits);
+}
+
+TrajectoryRecorder::~TrajectoryRecorder() {
+    stop();
+}
+
+bool TrajectoryRecorder::start(const std::string& path, int keyframes, TrajectoryOverflow mode, std::string& error) {
+    stop();
+    out.open(path.c_str(), std::ios::binary | std::ios::trunc);
+    if (!out) {
+        error = "cannot write " + path;
+        return false;
+    }
+    keyframeEvery = keyframes > 0 ? keyframes : 1;
+    overflow = mode;
+    prevCount = 0;
+    written.store(0, std::memory_order_relaxed);
+    dropped.store(0, std::memory_order_relaxed);
+
+    uint8_t header[TRAJECTORY_HEADER_BYTES];
+    std::memcpy(header, TRAJECTORY_MAGIC, sizeof(TRAJECTORY_MAGIC));
+    putU32(header + 8, TRAJECTORY_VERSION);
+    putU32(header + 12, static_cast<uint32_t>(keyframeEvery));
+    putF32(header + 16, TRAJECTORY_RANGE);
+    putF32(header + 20, TRAJECTORY_SCALE);
+    out.write(reinterpret_cast<const char*>(header), sizeof(header));
+    bytes.store(sizeof(header), std::memory_order_relaxed);
+
+    // Beide rijen zijn leeg na een vorige stop()
+    for (uint32_t k = 0; k < TRAJECTORY_BUFFER_FRAMES; ++k) empty.push(k);
+    stopping = false;
+    writer = std::thread(&TrajectoryRecorder::writerLoop, this);
+    return true;
+}
+
+void TrajectoryRecorder::stop() {
+    if (!writer.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    writer.join();
+
+    uint32_t slot;
+    while (empty.pop(slot)) {}
+    out.close();
+}
+
+void TrajectoryRecorder::record(const Simulation& sim) {
+    if (!writer.joinable()) return;
+
+    uint32_t slot;
+    while (!empty.pop(slot)) {
+        if (overflow == TrajectoryOverflow::Drop) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        std::this_thread::yield();
+    }
+
+    // In de volgorde van de store: een rechte doorloop, de writer zet ze op id
+    Frame& f = frames[slot];
+    const BallStore& balls = sim.balls();
+    const size_t n = balls.size();
+    f.x.reserve(n);
+    f.y.reserve(n);
+    f.id.reserve(n);
+    const float scale = TRAJECTORY_SCALE / TRAJECTORY_RANGE;
+    const float* x = balls.x().data();
+    const float* y = balls.y().data();
+    int16_t* qx = f.x.data();
+    int16_t* qy = f.y.data();
+    uint32_t* id = f.id.data();
+    for (size_t i = 0; i < n; ++i) {
+        qx[i] = quantize(x[i], scale);
+        qy[i] = quantize(y[i], scale);
+        id[i] = sim.ballId(i);
+    }
+    f.step = sim.stepCount();
+    f.count = n;
+    filled.push(slot);
+}
+
+void TrajectoryRecorder::writerLoop() {
+    bool done = false;
+    for (;;) {
+        uint32_t slot;
+        while (filled.pop(slot)) {
+            encode(frames[slot]);
+            empty.push(slot);
+        }
+        // Na stop() nog een keer leeghalen
+        if (done) break;
+        std::unique_lock<std::mutex> lock(wakeMutex);
+        done = wake.wait_for(lock, TRAJECTORY_WRITER_PERIOD, [this] { return stopping; });
+    }
+    out.flush();
+}
+
+void TrajectoryRecorder::encode(const Frame& f) {
+    const size_t n = f.count;
+    curX.reserve(n);
+    curY.reserve(n);
+    prevX.reserve(n);
+    prevY.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        curX[f.id[i]] = f.x[i];
+        curY[f.id[i]] = f.y[i];
+    }
+
+    const bool keyframe = written.load(std::memory_order_relaxed) % static_cast<uint64_t>(keyframeEvery) == 0;
+    const size_t predicted = keyframe ? 0 : (prevCount < n ? prevCount : n);
+    encoded.clear();
+    for (size_t k = 0; k < predicted; ++k) {
+        putVarint(encoded, zigzag(int32_t(curX[k]) - prevX[k]));
+        putVarint(encoded, zigzag(int32_t(curY[k]) - prevY[k]));
+    }
+    for (size_t k = predicted; k < n; ++k) {
+        putVarint(encoded, zigzag(curX[k]));
+        putVarint(encoded, zigzag(curY[k]));
+    }
+
+    std::vector<uint8_t>& header = frameHeader;
+    header.clear();
+    header.push_back(keyframe ? TRAJECTORY_KEYFRAME : TRAJECTORY_DELTA);
+    putVarint(header, f.step);
+    putVarint(header, n);
+    putVarint(header, encoded.size());
+    out.write(reinterpret_cast<const char*>(header.data()), static_cast<std::streamsize>(header.size()));
+    out.write(reinterpret_cast<const char*>(encoded.data()), static_cast<std::streamsize>(encoded.size()));
+
+    curX.swap(prevX);
+    curY.swap(prevY);
+    prevCount = n;
+    written.fetch_add(1, std::memory_order_relaxed);
+    bytes.fetch_add(header.size() + encoded.size(), std::memory_order_relaxed);
+}
+
+static bool getVarint(std::istream& in, uint64_t& v) {
+    v = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        int c = in.get();
+        if (c == EOF) return false;
+        v |= static_cast<uint64_t>(c & 0x7f) << shift;
+        if (!(c & 0x80)) return true;
+    }
+    return false;
+}
+
+static bool getVarint(const uint8_t*& p, const uint8_t* end, uint32_t& v) {
+    v = 0;
+    for (int shift = 0; shift < 35 && p < end; shift += 7) {
+        uint8_t c = *p++;
+        v |= static_cast<uint32_t>(c & 0x7f) << shift;
+        if (!(c & 0x80)) return true;
+    }
+    return false;
+}
+
+static uint32_t getU32(const uint8_t* p) {
+    return uint32_t(p[0]) | uint32_t(p[1]) << 8 | uint32_t(p[2]) << 16 | uint32_t(p[3]) << 24;
+}
+
+static float getF32(const uint8_t* p) {
+    uint32_t bits = getU32(p);
+    float v;
+    std::memcpy(&v, &bits, sizeof(v));
+    return v;
+}
+
+bool TrajectoryReader::open(const std::string& path, std::string& error) {
+    in.open(path.c_str(), std::ios::binary);
+    if (!in) {
+        error = "cannot open " + path;
+        return false;
+    }
+    uint8_t header[TRAJECTORY_HEADER_BYTES];
+    if (!in.read(reinterpret_cast<char*>(header), sizeof(header)) ||
+        std::memcmp(header, TRAJECTORY_MAGIC, sizeof(TRAJECTORY_MAGIC)) != 0) {
+        error = path + " is not a trajectory";
+        return false;
+    }
+    const uint32_t version = getU32(header + 8);
+    if (version != TRAJECTORY_VERSION) {
+        error = path + " has trajectory version " + std::to_string(version) + ", expected " +
+            std::to_string(TRAJECTORY_VERSION);
+        return false;
+    }
+    keyframes = static_cast<int>(getU32(header + 12));
+    range = getF32(header + 16);
+    scale = getF32(header + 20);
+    if (keyframes <= 0 || !(range > 0.0f) || !(scale > 0.0f)) {
+        error = path + " is damaged";
+        return false;
+    }
+    prevX.clear();
+    prevY.clear();
+    return true;
+}
+
+bool TrajectoryReader::next(TrajectoryFrame& frame, std::string& error) {
+    const int type = in.get();
+    if (type == EOF) return false;
+
+    uint64_t step, count, length;
+    if ((type != TRAJECTORY_KEYFRAME && type != TRAJECTORY_DELTA) || !getVarint(in, step) ||
+        !getVarint(in, count) || !getVarint(in, length) || count > VIRTUAL_ARRAY_MAX_ELEMENTS ||
+        length > 10 * count) {
+        error = "damaged frame header";
+        return false;
+    }
+    payload.resize(static_cast<size_t>(length));
+    if (!in.read(reinterpret_cast<char*>(payload.data()), static_cast<std::streamsize>(length))) {
+        error = "truncated frame";
+        return false;
+    }
+
+    // Een delta begint bij de vorige frame; nieuwe ballen bij nul
+    const size_t n = static_cast<size_t>(count);
+    const bool keyframe = type == TRAJECTORY_KEYFRAME;
+    if (keyframe) {
+        prevX.assign(n, 0);
+        prevY.assign(n, 0);
+    }
+    else {
+        prevX.resize(n, 0);
+        prevY.resize(n, 0);
+    }
+    const uint8_t* p = payload.data();
+    const uint8_t* end = p + payload.size();
+    for (size_t k = 0; k < n; ++k) {
+        uint32_t dx, dy;
+        if (!getVarint(p, end, dx) || !getVarint(p, end, dy)) {
+            error = "damaged frame";
+            return false;
+        }
+        prevX[k] += unzigzag(dx);
+        prevY[k] += unzigzag(dy);
+    }
+
+    const float unit = range / scale;
+    frame.step = step;
+    frame.keyframe = keyframe;
+    frame.x.resize(n);
+    frame.y.resize(n);
+    for (size_t k = 0; k < n; ++k) {
+        frame.x[k] = prevX[k] * unit;
+        frame.y[k] = prevY[k] * unit;
+    }
+    return true;
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Globals.h"
+#include "SpscQueue.h"
+#include "VirtualArray.h"
+
+class Simulation;
+
+// Opname van een hele run voor analyse achteraf. Posities worden 16-bit
+// fixed point: -TRAJECTORY_SCALE tot TRAJECTORY_SCALE over -TRAJECTORY_RANGE
+// tot TRAJECTORY_RANGE, een resolutie van ongeveer BALL_RADIUS / 400. Het
+// bereik is ruimer dan de cirkel omdat een overvolle start ballen even
+// voorbij de wand kan duwen; wat daar nog buiten valt wordt afgekapt.
+//
+// Bestand, versie 1, alles little-endian:
+//   "BALLTRAJ", uint32 versie, uint32 keyframeEvery, float TRAJECTORY_RANGE,
+//   float TRAJECTORY_SCALE
+//   per frame: byte 0 (keyframe) of 1 (delta), varint stap, varint aantal
+//   ballen, varint lengte van de payload, payload
+// De payload heeft per bal in id-volgorde x en y als zig-zag varint: bij een
+// keyframe de waarde zelf, anders het verschil met de vorige frame in het
+// bestand (een bal die daar nog niet was: met nul). Een lezer kan vanaf elk
+// keyframe beginnen en frames overslaan op de lengte.
+constexpr uint32_t TRAJECTORY_VERSION = 1;
+constexpr float TRAJECTORY_RANGE = 2.0f * CIRCLE_RADIUS;
+constexpr float TRAJECTORY_SCALE = 32767.0f;
+constexpr int TRAJECTORY_DEFAULT_KEYFRAME = 60;
+constexpr size_t TRAJECTORY_BUFFER_FRAMES = 8; // macht van twee voor SpscQueue
+
+enum class TrajectoryOverflow {
+    Drop, // alle buffers bij de writer: de frame valt weg (renderen, realtime)
+    Wait  // wachten op de writer: elke stap komt erin (headless)
+};
+
+// De simulatiethread kwantiseert elke stap de posities naar een van
+// TRAJECTORY_BUFFER_FRAMES vaste buffers; een achtergrondthread zet ze op
+// id-volgorde, codeert ze en schrijft ze weg. Het geheugen is begrensd op die
+// buffers en record() doet geen I/O en neemt geen lock. Een weggevallen frame
+// breekt niets: de volgende delta is tegen de laatst geschreven frame.
+class TrajectoryRecorder {
+public:
+    TrajectoryRecorder() = default;
+    ~TrajectoryRecorder();
+
+    TrajectoryRecorder(const TrajectoryRecorder&) = delete;
+    TrajectoryRecorder& operator=(const TrajectoryRecorder&) = delete;
+
+    bool start(const std::string& path, int keyframeEvery, TrajectoryOverflow overflow, std::string& error);
+    // Schrijft wat nog bij de writer ligt en sluit het bestand.
+    void stop();
+    bool recording() const { return writer.joinable(); }
+
+    // Alleen vanuit een thread.
+    void record(const Simulation& sim);
+
+    uint64_t framesWritten() const { return written.load(std::memory_order_relaxed); }
+    uint64_t framesDropped() const { return dropped.load(std::memory_order_relaxed); }
+    uint64_t bytesWritten() const { return bytes.load(std::memory_order_relaxed); }
+
+private:
+    struct Frame {
+        uint64_t step = 0;
+        size_t count = 0;
+        VirtualArray<int16_t> x; // in de volgorde van de store
+        VirtualArray<int16_t> y;
+        VirtualArray<uint32_t> id;
+    };
+
+    void writerLoop();
+    void encode(const Frame& frame);
+
+    Frame frames[TRAJECTORY_BUFFER_FRAMES];
+    SpscQueue<uint32_t, TRAJECTORY_BUFFER_FRAMES> filled; // record() -> writer
+    SpscQueue<uint32_t, TRAJECTORY_BUFFER_FRAMES> empty;  // writer -> record()
+    TrajectoryOverflow overflow = TrajectoryOverflow::Drop;
+    int keyframeEvery = TRAJECTORY_DEFAULT_KEYFRAME;
+
+    // Alleen van de writer
+    std::ofstream out;
+    VirtualArray<int16_t> prevX; // vorige geschreven frame, op id
+    VirtualArray<int16_t> prevY;
+    VirtualArray<int16_t> curX;
+    VirtualArray<int16_t> curY;
+    size_t prevCount = 0;
+    std::vector<uint8_t> frameHeader; // groeien alleen met het aantal ballen
+    std::vector<uint8_t> encoded;
+
+    std::atomic<uint64_t> written{ 0 };
+    std::atomic<uint64_t> dropped{ 0 };
+    std::atomic<uint64_t> bytes{ 0 };
+
+    std::thread writer;
+    std::mutex wakeMutex;
+    std::condition_variable wake;
+    bool stopping = false;
+};
+
+// Een gedecodeerde frame: posities op id.
+struct TrajectoryFrame {
+    uint64_t step = 0;
+    bool keyframe = false;
+    std::vector<float> x;
+    std::vector<float> y;
+};
+
+// Leest een opname frame voor frame terug.
+class TrajectoryReader {
+public:
+    bool open(const std::string& path, std::string& error);
+    // false aan het eind van het bestand, of bij een fout (dan is error gezet).
+    bool next(TrajectoryFrame& frame, std::string& error);
+    int keyframeEvery() const { return keyframes; }
+
+private:
+    std::ifstream in;
+    int keyframes = 0;
+    float scale = TRAJECTORY_SCALE;
+    float range = 0.0f;
+    std::vector<int32_t> prevX;
+    std::vector<int32_t> prevY;
+    std::vector<uint8_t> payload;
+};
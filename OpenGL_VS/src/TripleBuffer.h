@@ -0,0 +1,44 @@
+#pragma once
+
+#include <atomic>
+
+// Lock-free overdracht van de nieuwste toestand van een schrijvende naar een
+// lezende thread. Er zijn drie exemplaren van T: de schrijver vult back(), de
+// lezer leest front() en het derde ligt klaar in het midden. publish() ruilt
+// back met het midden, acquire() ruilt front met het midden als daar iets
+// nieuws ligt. Geen van beide wacht ooit op de ander; een lezer die achterloopt
+// slaat tussenliggende toestanden over en een snelle lezer ziet dezelfde
+// toestand meerdere keren.
+template <typename T>
+class TripleBuffer {
+public:
+    // Schrijvende thread: het exemplaar dat gevuld mag worden.
+    T& back() { return slots[backIndex]; }
+
+    // Schrijvende thread: maakt back() zichtbaar voor de lezer.
+    void publish() {
+        unsigned previous = middle.exchange(backIndex | FRESH, std::memory_order_acq_rel);
+        backIndex = previous & INDEX_MASK;
+    }
+
+    // Lezende thread: haalt de nieuwste gepubliceerde toestand op; true als
+    // front() daardoor veranderd is.
+    bool acquire() {
+        if (!(middle.load(std::memory_order_relaxed) & FRESH)) return false;
+        unsigned previous = middle.exchange(frontIndex, std::memory_order_acq_rel);
+        frontIndex = previous & INDEX_MASK;
+        return true;
+    }
+
+    // Lezende thread: blijft geldig tot de volgende acquire().
+    const T& front() const { return slots[frontIndex]; }
+
+private:
+    static const unsigned INDEX_MASK = 3;
+    static const unsigned FRESH = 4;
+
+    T slots[3];
+    unsigned backIndex = 0;                  // alleen de schrijver
+    unsigned frontIndex = 1;                 // alleen de lezer
+    alignas(64) std::atomic<unsigned> middle{ 2 };
+};
@@ -0,0 +1,152 @@
+#include "VirtualArray.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+void* reserveAddressSpace(size_t bytes) {
+#ifdef _WIN32
+    void* p = VirtualAlloc(nullptr, bytes, MEM_RESERVE, PAGE_NOACCESS);
+#else
+    void* p = mmap(nullptr, bytes, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (p == MAP_FAILED) p = nullptr;
+#endif
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void commitAddressSpace(void* base, size_t fromBytes, size_t toBytes) {
+    if (toBytes <= fromBytes) return;
+    char* start = static_cast<char*>(base) + fromBytes;
+#ifdef _WIN32
+    bool ok = VirtualAlloc(start, toBytes - fromBytes, MEM_COMMIT, PAGE_READWRITE) != nullptr;
+#else
+    bool ok = mprotect(start, toBytes - fromBytes, PROT_READ | PROT_WRITE) == 0;
+#endif
+    if (!ok) throw std::bad_alloc();
+}
+
+void releaseAddressSpace(void* base, size_t bytes, size_t mappedBytes) {
+#ifdef _WIN32
+    // Een view en de reservering erachter zijn twee aparte regio's
+    if (mappedBytes) {
+        UnmapViewOfFile(base);
+        if (bytes > mappedBytes) VirtualFree(static_cast<char*>(base) + mappedBytes, 0, MEM_RELEASE);
+    }
+    else {
+        VirtualFree(base, 0, MEM_RELEASE);
+    }
+#else
+    (void)mappedBytes;
+    munmap(base, bytes);
+#endif
+}
+
+void* mapFileAddressSpace(const MappedFile& file, uint64_t offset, size_t bytes, size_t reservedBytes) {
+    if (!file.isOpen() || bytes == 0 || offset + bytes > file.size()) return nullptr;
+#ifdef _WIN32
+    // Een view kan niet in een bestaande reservering; dus reserveren om een
+    // vrij adres te vinden, vrijgeven en daar de view plus een nieuwe
+    // reservering voor de rest neerleggen. Pakt een andere thread het adres
+    // tussendoor, dan mislukt de view en leest de aanroeper het bestand.
+    if (!file.mapping) return nullptr;
+    void* base = reserveAddressSpace(reservedBytes);
+    VirtualFree(base, 0, MEM_RELEASE);
+    void* view = MapViewOfFileEx(file.mapping, FILE_MAP_COPY, static_cast<DWORD>(offset >> 32),
+        static_cast<DWORD>(offset & 0xFFFFFFFFu), bytes, base);
+    if (!view) return nullptr;
+    if (reservedBytes > bytes &&
+        !VirtualAlloc(static_cast<char*>(view) + bytes, reservedBytes - bytes, MEM_RESERVE, PAGE_NOACCESS)) {
+        UnmapViewOfFile(view);
+        return nullptr;
+    }
+    return view;
+#else
+    // MAP_FIXED vervangt alleen het begin van de reservering
+    void* base = reserveAddressSpace(reservedBytes);
+    void* view = mmap(base, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, file.fd, static_cast<off_t>(offset));
+    if (view == MAP_FAILED) {
+        munmap(base, reservedBytes);
+        return nullptr;
+    }
+    return base;
+#endif
+}
+
+bool MappedFile::open(const char* path) {
+    close();
+#ifdef _WIN32
+    HANDLE h = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (h == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER length;
+    if (!GetFileSizeEx(h, &length)) {
+        CloseHandle(h);
+        return false;
+    }
+    file = h;
+    bytes = static_cast<uint64_t>(length.QuadPart);
+    // Een lege file kan niet gemapt worden; lezen faalt dan vanzelf op de lengte
+    if (bytes) mapping = CreateFileMappingA(h, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+#else
+    fd = ::open(path, O_RDONLY);
+    if (fd < 0) return false;
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        close();
+        return false;
+    }
+    bytes = static_cast<uint64_t>(info.st_size);
+#endif
+    return true;
+}
+
+void MappedFile::close() {
+#ifdef _WIN32
+    if (mapping) CloseHandle(mapping);
+    if (file) CloseHandle(file);
+    mapping = nullptr;
+    file = nullptr;
+#else
+    if (fd >= 0) ::close(fd);
+    fd = -1;
+#endif
+    bytes = 0;
+}
+
+bool MappedFile::isOpen() const {
+#ifdef _WIN32
+    return file != nullptr;
+#else
+    return fd >= 0;
+#endif
+}
+
+bool MappedFile::read(uint64_t offset, void* out, size_t count) const {
+    if (offset + count > bytes) return false;
+    char* dst = static_cast<char*>(out);
+    while (count > 0) {
+        // Per keer hoogstens 1 GiB; ReadFile neemt maar 32 bits
+        size_t part = count < (size_t(1) << 30) ? count : size_t(1) << 30;
+#ifdef _WIN32
+        OVERLAPPED at = {};
+        at.Offset = static_cast<DWORD>(offset & 0xFFFFFFFFu);
+        at.OffsetHigh = static_cast<DWORD>(offset >> 32);
+        DWORD got = 0;
+        if (!ReadFile(file, dst, static_cast<DWORD>(part), &got, &at) || got == 0) return false;
+#else
+        ssize_t got = pread(fd, dst, part, static_cast<off_t>(offset));
+        if (got <= 0) return false;
+#endif
+        dst += got;
+        offset += static_cast<uint64_t>(got);
+        count -= static_cast<size_t>(got);
+    }
+    return true;
+}
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+
+// Maximaal aantal elementen per VirtualArray. Dit is alleen gereserveerde
+// adresruimte; geheugen kost pas iets als het gecommit wordt.
+constexpr size_t VIRTUAL_ARRAY_MAX_ELEMENTS = sizeof(void*) == 8 ? size_t(1) << 26 : size_t(1) << 20;
+
+// Er wordt in stappen van deze grootte gecommit (de allocatiegranulariteit
+// van Windows), zodat groeien zelden een systeemaanroep kost.
+constexpr size_t VIRTUAL_ARRAY_COMMIT_BYTES = 64 * 1024;
+
+// Bestand dat alleen gelezen wordt, om stukken uit in een VirtualArray te
+// mappen (zie VirtualArray::adopt). Mag gesloten worden terwijl die stukken
+// nog gemapt zijn.
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile() { close(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const char* path);
+    void close();
+    bool isOpen() const;
+    uint64_t size() const { return bytes; }
+
+    // Gewoon lezen, voor kleine stukken en als mappen niet lukt.
+    bool read(uint64_t offset, void* out, size_t count) const;
+
+private:
+    friend void* mapFileAddressSpace(const MappedFile&, uint64_t, size_t, size_t);
+#ifdef _WIN32
+    void* file = nullptr;    // HANDLE
+    void* mapping = nullptr; // HANDLE van CreateFileMapping
+#else
+    int fd = -1;
+#endif
+    uint64_t bytes = 0;
+};
+
+void* reserveAddressSpace(size_t bytes);
+void commitAddressSpace(void* base, size_t fromBytes, size_t toBytes);
+// mappedBytes: het begin dat een view op een bestand is (mapFileAddressSpace).
+void releaseAddressSpace(void* base, size_t bytes, size_t mappedBytes = 0);
+// Reserveert reservedBytes en legt over de eerste bytes een copy-on-write view
+// op file vanaf offset; nullptr als dat niet lukt.
+void* mapFileAddressSpace(const MappedFile& file, uint64_t offset, size_t bytes, size_t reservedBytes);
+
+// Array van triviaal kopieerbare elementen in een vooraf gereserveerd stuk
+// adresruimte. Groeien commit alleen extra pagina's achter de bestaande: de
+// elementen verplaatsen nooit, er wordt niets gekopieerd en er is geen
+// heap-allocatie. Nieuw gecommit geheugen is nul.
+template <typename T>
+class VirtualArray {
+public:
+    VirtualArray() = default;
+    ~VirtualArray() { release(); }
+
+    VirtualArray(const VirtualArray&) = delete;
+    VirtualArray& operator=(const VirtualArray&) = delete;
+
+    T* data() { return base; }
+    const T* data() const { return base; }
+    size_t capacity() const { return committed / sizeof(T); }
+
+    // Zorgt dat de eerste n elementen bruikbaar zijn.
+    void reserve(size_t n) {
+        if (n <= capacity()) return;
+        if (n > VIRTUAL_ARRAY_MAX_ELEMENTS) throw std::bad_alloc();
+        if (!base) base = static_cast<T*>(reserveAddressSpace(VIRTUAL_ARRAY_MAX_ELEMENTS * sizeof(T)));
+        size_t bytes = (n * sizeof(T) + VIRTUAL_ARRAY_COMMIT_BYTES - 1) / VIRTUAL_ARRAY_COMMIT_BYTES * VIRTUAL_ARRAY_COMMIT_BYTES;
+        if (bytes > VIRTUAL_ARRAY_MAX_ELEMENTS * sizeof(T)) bytes = VIRTUAL_ARRAY_MAX_ELEMENTS * sizeof(T);
+        commitAddressSpace(base, committed, bytes);
+        committed = bytes;
+    }
+
+    // Wisselt de inhoud in O(1); er wordt niets gekopieerd.
+    void swap(VirtualArray& other) {
+        T* b = base; base = other.base; other.base = b;
+        size_t c = committed; committed = other.committed; other.committed = c;
+        size_t m = mapped; mapped = other.mapped; other.mapped = m;
+    }
+
+    // Vervangt de inhoud door bytes uit file vanaf offset, als copy-on-write
+    // view: er wordt niets gelezen of gekopieerd, pagina's komen pas bij het
+    // eerste gebruik van schijf en schrijven komt niet in het bestand. Groeien
+    // daarna gaat gewoon verder achter de view. offset en bytes moeten
+    // veelvouden van VIRTUAL_ARRAY_COMMIT_BYTES zijn. Lukt mappen niet, dan
+    // wordt het stuk gelezen; false alleen als ook dat mislukt.
+    bool adopt(const MappedFile& file, uint64_t offset, size_t bytes) {
+        if (bytes > VIRTUAL_ARRAY_MAX_ELEMENTS * sizeof(T)) return false;
+        release();
+        base = static_cast<T*>(mapFileAddressSpace(file, offset, bytes, VIRTUAL_ARRAY_MAX_ELEMENTS * sizeof(T)));
+        if (base) {
+            committed = mapped = bytes;
+            return true;
+        }
+        reserve(bytes / sizeof(T));
+        return file.read(offset, base, bytes);
+    }
+
+    // Of het begin nog een view op een bestand is.
+    bool isMapped() const { return mapped != 0; }
+
+    // Kopieert een gemapt begin naar eigen geheugen, zodat het bestand weer
+    // vrij is (Windows kan een gemapt bestand niet vervangen).
+    void detach() {
+        if (!mapped) return;
+        VirtualArray copy;
+        copy.reserve(committed / sizeof(T));
+        std::memcpy(copy.base, base, committed);
+        swap(copy);
+    }
+
+    T& operator[](size_t i) { return base[i]; }
+    const T& operator[](size_t i) const { return base[i]; }
+
+private:
+    void release() {
+        if (base) releaseAddressSpace(base, VIRTUAL_ARRAY_MAX_ELEMENTS * sizeof(T), mapped);
+        base = nullptr;
+        committed = mapped = 0;
+    }
+
+    T* base = nullptr;
+    size_t committed = 0; // bytes
+    size_t mapped = 0;    // bytes aan het begin uit een bestand (adopt)
+};
@@ -0,0 +1,216 @@
+#include "WallKernel.h"
+#include "CpuFeatures.h"
+#include "Globals.h"
+#include <cmath>
+
+#if BALLS_X86
+#include <immintrin.h>
+#endif
+
+// Een bal raakt de rand zodra dist + BALL_RADIUS >= CIRCLE_RADIUS; in het
+// kwadraat hoeft er geen wortel getrokken te worden voor de test.
+constexpr float WALL_DIST = CIRCLE_RADIUS - BALL_RADIUS;
+constexpr float WALL_DIST_SQ = WALL_DIST * WALL_DIST;
+constexpr float WALL_PUSH = 0.001f;
+
+size_t integrateAndReflectScalar(BallStore& balls, size_t begin, size_t end, float dt, uint32_t* hits) {
+    Span<float> x = balls.x();
+    Span<float> y = balls.y();
+    Span<float> vx = balls.vx();
+    Span<float> vy = balls.vy();
+
+    size_t hitCount = 0;
+    for (size_t i = begin; i < end; ++i) {
+        x[i] += vx[i] * dt;
+        y[i] += vy[i] * dt;
+
+        float dist = std::sqrt(x[i] * x[i] + y[i] * y[i]);
+        if (dist + BALL_RADIUS >= CIRCLE_RADIUS) {
+            float nx = x[i] / dist;
+            float ny = y[i] / dist;
+            float dot = vx[i] * nx + vy[i] * ny;
+            vx[i] -= 2 * dot * nx;
+            vy[i] -= 2 * dot * ny;
+            x[i] -= nx * WALL_PUSH;
+            y[i] -= ny * WALL_PUSH;
+            hits[hitCount++] = static_cast<uint32_t>(i);
+        }
+    }
+    return hitCount;
+}
+
+#if BALLS_X86
+
+// De opvulling van BallStore staat op nul en raakt dus nooit de rand, daarom
+// mogen de SIMD-lussen tot een hele vector voorbij end doorlopen zolang end
+// gelijk is aan size() of een veelvoud van BALL_STORE_LANES.
+
+TARGET_SSE2 size_t integrateAndReflectSSE2(BallStore& balls, size_t begin, size_t end, float dt, uint32_t* hits) {
+    float* x = balls.x().data();
+    float* y = balls.y().data();
+    float* vx = balls.vx().data();
+    float* vy = balls.vy().data();
+
+    const __m128 wallSq = _mm_set1_ps(WALL_DIST_SQ);
+    const __m128 half = _mm_set1_ps(0.5f);
+    const __m128 threeHalves = _mm_set1_ps(1.5f);
+    const __m128 two = _mm_set1_ps(2.0f);
+    const __m128 push = _mm_set1_ps(WALL_PUSH);
+    const __m128 step = _mm_set1_ps(dt);
+
+    size_t hitCount = 0;
+    for (size_t i = begin; i < end; i += 4) {
+        __m128 pvx = _mm_load_ps(vx + i);
+        __m128 pvy = _mm_load_ps(vy + i);
+        __m128 px = _mm_add_ps(_mm_load_ps(x + i), _mm_mul_ps(pvx, step));
+        __m128 py = _mm_add_ps(_mm_load_ps(y + i), _mm_mul_ps(pvy, step));
+
+        __m128 d2 = _mm_add_ps(_mm_mul_ps(px, px), _mm_mul_ps(py, py));
+        __m128 hit = _mm_cmpge_ps(d2, wallSq);
+        int mask = _mm_movemask_ps(hit);
+
+        if (mask) {
+            // rsqrt met een Newton-stap: inv * (1.5 - 0.5 * d2 * inv^2)
+            __m128 inv = _mm_rsqrt_ps(d2);
+            inv = _mm_mul_ps(inv, _mm_sub_ps(threeHalves, _mm_mul_ps(_mm_mul_ps(half, d2), _mm_mul_ps(inv, inv))));
+            __m128 nx = _mm_and_ps(_mm_mul_ps(px, inv), hit);
+            __m128 ny = _mm_and_ps(_mm_mul_ps(py, inv), hit);
+
+            __m128 dot2 = _mm_mul_ps(two, _mm_add_ps(_mm_mul_ps(pvx, nx), _mm_mul_ps(pvy, ny)));
+            pvx = _mm_sub_ps(pvx, _mm_mul_ps(dot2, nx));
+            pvy = _mm_sub_ps(pvy, _mm_mul_ps(dot2, ny));
+            px = _mm_sub_ps(px, _mm_mul_ps(nx, push));
+            py = _mm_sub_ps(py, _mm_mul_ps(ny, push));
+            _mm_store_ps(vx + i, pvx);
+            _mm_store_ps(vy + i, pvy);
+
+            uint32_t bits = static_cast<uint32_t>(mask);
+            while (bits) {
+                hits[hitCount++] = static_cast<uint32_t>(i + countTrailingZeros(bits));
+                bits &= bits - 1;
+            }
+        }
+        _mm_store_ps(x + i, px);
+        _mm_store_ps(y + i, py);
+    }
+    return hitCount;
+}
+
+TARGET_AVX2 size_t integrateAndReflectAVX2(BallStore& balls, size_t begin, size_t end, float dt, uint32_t* hits) {
+    float* x = balls.x().data();
+    float* y = balls.y().data();
+    float* vx = balls.vx().data();
+    float* vy = balls.vy().data();
+
+    const __m256 wallSq = _mm256_set1_ps(WALL_DIST_SQ);
+    const __m256 half = _mm256_set1_ps(0.5f);
+    const __m256 threeHalves = _mm256_set1_ps(1.5f);
+    const __m256 two = _mm256_set1_ps(2.0f);
+    const __m256 push = _mm256_set1_ps(WALL_PUSH);
+    const __m256 step = _mm256_set1_ps(dt);
+
+    size_t hitCount = 0;
+    for (size_t i = begin; i < end; i += 8) {
+        __m256 pvx = _mm256_load_ps(vx + i);
+        __m256 pvy = _mm256_load_ps(vy + i);
+        __m256 px = _mm256_fmadd_ps(pvx, step, _mm256_load_ps(x + i));
+        __m256 py = _mm256_fmadd_ps(pvy, step, _mm256_load_ps(y + i));
+
+        __m256 d2 = _mm256_fmadd_ps(px, px, _mm256_mul_ps(py, py));
+        __m256 hit = _mm256_cmp_ps(d2, wallSq, _CMP_GE_OQ);
+        int mask = _mm256_movemask_ps(hit);
+
+        if (mask) {
+            __m256 inv = _mm256_rsqrt_ps(d2);
+            inv = _mm256_mul_ps(inv, _mm256_fnmadd_ps(_mm256_mul_ps(half, d2), _mm256_mul_ps(inv, inv), threeHalves));
+            __m256 nx = _mm256_and_ps(_mm256_mul_ps(px, inv), hit);
+            __m256 ny = _mm256_and_ps(_mm256_mul_ps(py, inv), hit);
+
+            __m256 dot2 = _mm256_mul_ps(two, _mm256_fmadd_ps(pvx, nx, _mm256_mul_ps(pvy, ny)));
+            pvx = _mm256_fnmadd_ps(dot2, nx, pvx);
+            pvy = _mm256_fnmadd_ps(dot2, ny, pvy);
+            px = _mm256_fnmadd_ps(nx, push, px);
+            py = _mm256_fnmadd_ps(ny, push, py);
+            _mm256_store_ps(vx + i, pvx);
+            _mm256_store_ps(vy + i, pvy);
+
+            uint32_t bits = static_cast<uint32_t>(mask);
+            while (bits) {
+                hits[hitCount++] = static_cast<uint32_t>(i + countTrailingZeros(bits));
+                bits &= bits - 1;
+            }
+        }
+        _mm256_store_ps(x + i, px);
+        _mm256_store_ps(y + i, py);
+    }
+    return hitCount;
+}
+
+// Zestien ballen per vector, precies BALL_STORE_LANES; de hits zijn een masker.
+TARGET_AVX512 size_t integrateAndReflectAVX512(BallStore& balls, size_t begin, size_t end, float dt, uint32_t* hits) {
+    float* x = balls.x().data();
+    float* y = balls.y().data();
+    float* vx = balls.vx().data();
+    float* vy = balls.vy().data();
+
+    const __m512 wallSq = _mm512_set1_ps(WALL_DIST_SQ);
+    const __m512 half = _mm512_set1_ps(0.5f);
+    const __m512 threeHalves = _mm512_set1_ps(1.5f);
+    const __m512 two = _mm512_set1_ps(2.0f);
+    const __m512 push = _mm512_set1_ps(WALL_PUSH);
+    const __m512 step = _mm512_set1_ps(dt);
+
+    size_t hitCount = 0;
+    for (size_t i = begin; i < end; i += 16) {
+        __m512 pvx = _mm512_load_ps(vx + i);
+        __m512 pvy = _mm512_load_ps(vy + i);
+        __m512 px = _mm512_fmadd_ps(pvx, step, _mm512_load_ps(x + i));
+        __m512 py = _mm512_fmadd_ps(pvy, step, _mm512_load_ps(y + i));
+
+        __m512 d2 = _mm512_fmadd_ps(px, px, _mm512_mul_ps(py, py));
+        __mmask16 hit = _mm512_cmp_ps_mask(d2, wallSq, _CMP_GE_OQ);
+
+        if (hit) {
+            __m512 inv = _mm512_rsqrt14_ps(d2);
+            inv = _mm512_mul_ps(inv, _mm512_fnmadd_ps(_mm512_mul_ps(half, d2), _mm512_mul_ps(inv, inv), threeHalves));
+            __m512 nx = _mm512_maskz_mul_ps(hit, px, inv);
+            __m512 ny = _mm512_maskz_mul_ps(hit, py, inv);
+
+            __m512 dot2 = _mm512_mul_ps(two, _mm512_fmadd_ps(pvx, nx, _mm512_mul_ps(pvy, ny)));
+            pvx = _mm512_fnmadd_ps(dot2, nx, pvx);
+            pvy = _mm512_fnmadd_ps(dot2, ny, pvy);
+            px = _mm512_fnmadd_ps(nx, push, px);
+            py = _mm512_fnmadd_ps(ny, push, py);
+            _mm512_store_ps(vx + i, pvx);
+            _mm512_store_ps(vy + i, pvy);
+
+            uint32_t bits = static_cast<uint32_t>(hit);
+            while (bits) {
+                hits[hitCount++] = static_cast<uint32_t>(i + countTrailingZeros(bits));
+                bits &= bits - 1;
+            }
+        }
+        _mm512_store_ps(x + i, px);
+        _mm512_store_ps(y + i, py);
+    }
+    return hitCount;
+}
+
+#endif
+
+// Geen aparte SSE4.2-versie: deze kernel gebruikt niets uit SSE4, dus zo'n
+// CPU krijgt de SSE2-versie.
+const KernelVariant<WallKernelFn> WALL_KERNELS[] = {
+    { KernelIsa::Scalar, integrateAndReflectScalar },
+#if BALLS_X86
+    { KernelIsa::SSE2, integrateAndReflectSSE2 },
+    { KernelIsa::AVX2, integrateAndReflectAVX2 },
+    { KernelIsa::AVX512, integrateAndReflectAVX512 },
+#endif
+};
+const size_t WALL_KERNEL_COUNT = sizeof(WALL_KERNELS) / sizeof(WALL_KERNELS[0]);
+
+WallKernel selectWallKernel() {
+    const KernelVariant<WallKernelFn>& picked = pickKernel(WALL_KERNELS, WALL_KERNEL_COUNT);
+    return { kernelIsaName(picked.isa), picked.fn };
+}
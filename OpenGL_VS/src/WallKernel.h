@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+#include "BallStore.h"
+#include "CpuFeatures.h"
+#include "KernelRegistry.h"
+
+// Verplaatst de ballen [begin, end) over dt referentiestappen (zie
+// SIM_REFERENCE_HZ) en kaatst ze terug tegen de arenarand. begin moet een
+// veelvoud van BALL_STORE_LANES zijn. De indices van ballen die de rand
+// raakten komen in hits (plaats voor end - begin indices); het aantal hits
+// wordt teruggegeven.
+typedef size_t (*WallKernelFn)(BallStore& balls, size_t begin, size_t end, float dt, uint32_t* hits);
+
+struct WallKernel {
+    const char* name;
+    WallKernelFn fn;
+};
+
+size_t integrateAndReflectScalar(BallStore& balls, size_t begin, size_t end, float dt, uint32_t* hits);
+#if BALLS_X86
+size_t integrateAndReflectSSE2(BallStore& balls, size_t begin, size_t end, float dt, uint32_t* hits);
+size_t integrateAndReflectAVX2(BallStore& balls, size_t begin, size_t end, float dt, uint32_t* hits);
+size_t integrateAndReflectAVX512(BallStore& balls, size_t begin, size_t end, float dt, uint32_t* hits);
+#endif
+
+// Alle varianten voor de KernelRegistry, oplopend op ISA.
+extern const KernelVariant<WallKernelFn> WALL_KERNELS[];
+extern const size_t WALL_KERNEL_COUNT;
+
+// Kiest de snelste kernel die de CPU ondersteunt, binnen BALLS_ISA.
+WallKernel selectWallKernel();
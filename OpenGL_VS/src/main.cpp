@@ -5,28 +5,166 @@
 #include <cstdlib>
 #include <ctime>
 #include <cmath>
+#include <string>
+#include <cstdio>
+#include <algorithm>
+#include <cassert>
 
 #include "Globals.h"
-#include "Ball.h"
+#include "AllocationCounter.h"
+#include "BallStore.h"
 #include "Utils.h"
+#include "Simulation.h"
+#include "EventSimulation.h"
+#include "SimulationThread.h"
+#include "BallRenderer.h"
+#include "Benchmark.h"
+#include "KernelRegistry.h"
+#include "Profiler.h"
+#include "StatsLog.h"
+#include "TextOverlay.h"
+#include "Trajectory.h"
 
 // Globale besturingsvariabelen
-bool isRunning = true;
-bool resetRequested = false;
+bool renderModeToggled = false;
+bool overlayVisible = false;
+
+// Opdrachten voor de simulatiethread; key_callback is de enige schrijver
+SimCommandQueue simCommands;
 
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods) {
     if (action == GLFW_PRESS) {
         if (key == GLFW_KEY_SPACE) {
-            isRunning = !isRunning; // Start/Stop
+            simCommands.push(SimCommand::TogglePause); // Start/Stop
         }
         if (key == GLFW_KEY_R) {
-            resetRequested = true;  // Reset
+            simCommands.push(SimCommand::Reset);       // Reset
+        }
+        if (key == GLFW_KEY_M) {
+            renderModeToggled = true; // Waaier/quad wisselen
+        }
+        if (key == GLFW_KEY_O) {
+            overlayVisible = !overlayVisible; // Statistieken in beeld
+        }
+        if (key == GLFW_KEY_F5) {
+            simCommands.push(SimCommand::SaveCheckpoint); // Toestand opslaan
+        }
+        if (key == GLFW_KEY_F9) {
+            simCommands.push(SimCommand::LoadCheckpoint); // Terug naar de opgeslagen toestand
         }
     }
 }
 
-int main() {
-    srand(static_cast<unsigned>(time(0)));
+int main(int argc, char** argv) {
+    unsigned threads = defaultThreadCount();
+    double simHz = DEFAULT_SIM_HZ;
+    uint64_t seed = static_cast<uint64_t>(time(0));
+    BallRenderMode renderMode = BallRenderMode::Quad;
+    bool eventDriven = false;
+    Broadphase broadphase = Broadphase::NeighbourList;
+    ContactMode contactMode = ContactMode::Off;
+    SpawnPlacement spawnPlacement = SpawnPlacement::Search;
+#ifdef BALLS_PROFILE
+    std::string tracePath = "trace.json";
+#else
+    std::string tracePath;
+#endif
+    double statsHz = 1.0;
+    StatsFormat statsFormat = StatsFormat::Text;
+    std::string statsPath;
+    std::string checkpointPath;
+    std::string loadPath;
+    std::string recordPath;
+    int recordKeyframe = TRAJECTORY_DEFAULT_KEYFRAME;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--threads" && i + 1 < argc) {
+            threads = static_cast<unsigned>(std::atoi(argv[++i]));
+        }
+        else if (arg == "--sim-hz" && i + 1 < argc) {
+            simHz = std::atof(argv[++i]);
+            if (simHz <= 0.0) simHz = DEFAULT_SIM_HZ;
+        }
+        else if (arg == "--seed" && i + 1 < argc) {
+            seed = std::strtoull(argv[++i], nullptr, 10);
+        }
+        else if (arg == "--engine" && i + 1 < argc) {
+            eventDriven = std::string(argv[++i]) == "event";
+        }
+        else if (arg == "--broadphase" && i + 1 < argc) {
+            broadphase = std::string(argv[++i]) == "grid" ? Broadphase::Grid : Broadphase::NeighbourList;
+        }
+        else if (arg == "--contacts" && i + 1 < argc) {
+            std::string mode = argv[++i];
+            contactMode = mode == "warm" ? ContactMode::Warm : mode == "cold" ? ContactMode::Cold : ContactMode::Off;
+        }
+        else if (arg == "--spawn" && i + 1 < argc) {
+            spawnPlacement = std::string(argv[++i]) == "origin" ? SpawnPlacement::Origin : SpawnPlacement::Search;
+        }
+        else if (arg == "--render" && i + 1 < argc) {
+            renderMode = std::string(argv[++i]) == "fan" ? BallRenderMode::Fan : BallRenderMode::Quad;
+        }
+        else if (arg == "--trace" && i + 1 < argc) {
+            tracePath = argv[++i];
+        }
+        else if (arg == "--stats-hz" && i + 1 < argc) {
+            statsHz = std::atof(argv[++i]);
+        }
+        else if (arg == "--stats-format" && i + 1 < argc) {
+            if (!parseStatsFormat(argv[++i], statsFormat)) {
+                std::cerr << "Unknown stats format " << argv[i] << " (text or json)" << std::endl;
+                return 1;
+            }
+        }
+        else if (arg == "--stats-out" && i + 1 < argc) {
+            statsPath = argv[++i];
+        }
+        else if (arg == "--checkpoint" && i + 1 < argc) {
+            checkpointPath = argv[++i];
+        }
+        else if (arg == "--load" && i + 1 < argc) {
+            loadPath = argv[++i];
+        }
+        else if (arg == "--record" && i + 1 < argc) {
+            recordPath = argv[++i];
+        }
+        else if (arg == "--record-keyframe" && i + 1 < argc) {
+            recordKeyframe = std::atoi(argv[++i]);
+        }
+        else if (arg == "--overlay") {
+            overlayVisible = true;
+        }
+        else if (arg == "--bench-broadphase") {
+            runBroadphaseBenchmark();
+            return 0;
+        }
+        else if (arg == "--bench-threads") {
+            runThreadScalingBenchmark(threads);
+            return 0;
+        }
+        else if (arg == "--bench-reorder") {
+            runReorderBenchmark();
+            return 0;
+        }
+        else if (arg == "--list-kernels") {
+            printKernels(std::cout);
+            return 0;
+        }
+        else if (arg == "--check-kernels") {
+            return checkWallKernels(std::cout) ? 0 : 1;
+        }
+    }
+
+    if (!loadPath.empty() && eventDriven) {
+        std::cerr << "--load needs the step engine" << std::endl;
+        return 1;
+    }
+    if (!recordPath.empty() && eventDriven) {
+        std::cerr << "--record needs the step engine" << std::endl;
+        return 1;
+    }
+    // F5 en F9 gebruiken het geladen bestand als er geen ander is opgegeven
+    if (checkpointPath.empty()) checkpointPath = loadPath.empty() ? "balls.ckpt" : loadPath;
 
     glfwInit();
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
@@ -85,101 +223,196 @@ int main() {
     glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
     glEnableVertexAttribArray(0);
 
-    // Ballen
-    std::vector<float> ballVertices = generateCircleVertices(BALL_RADIUS, CIRCLE_SEGMENTS);
-    GLuint ballVAO, ballVBO;
-    glGenVertexArrays(1, &ballVAO);
-    glGenBuffers(1, &ballVBO);
-    glBindVertexArray(ballVAO);
-    glBindBuffer(GL_ARRAY_BUFFER, ballVBO);
-    glBufferData(GL_ARRAY_BUFFER, ballVertices.size() * sizeof(float), ballVertices.data(), GL_STATIC_DRAW);
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-
     GLint offsetLoc = glGetUniformLocation(shaderProgram, "offset");
     GLint colorLoc = glGetUniformLocation(shaderProgram, "color");
 
-    std::vector<Ball> balls = { { 0.0f, 0.0f, INITIAL_SPEED, INITIAL_SPEED } };
+    Simulation sim(threads, simHz, seed);
+    sim.setBroadphase(broadphase);
+    sim.setContactMode(contactMode);
+    sim.setSpawnPlacement(spawnPlacement);
+    EventSimulation eventSim(seed);
+    if (!loadPath.empty()) {
+        std::string error;
+        if (!sim.loadCheckpoint(loadPath, error)) {
+            std::cerr << "Cannot load checkpoint: " << error << std::endl;
+            return 1;
+        }
+    }
+    BallRenderer ballRenderer;
+    ballRenderer.setMode(renderMode);
+    std::cout << "Engine: " << (eventDriven ? "event" : "step")
+        << ", wall kernel: " << sim.wallKernel().name
+        << ", pair kernel: " << sim.pairKernel().name
+        << ", broadphase: " << (broadphase == Broadphase::Grid ? "grid" : "list")
+        << ", contacts: " << (contactMode == ContactMode::Warm ? "warm" : contactMode == ContactMode::Cold ? "cold" : "off")
+        << ", spawn: " << (spawnPlacement == SpawnPlacement::Origin ? "origin" : "search")
+        << ", threads: " << sim.threadCount()
+        << ", sim rate: " << simHz << " Hz"
+        << ", seed: " << sim.seed()
+        << ", checkpoint: " << checkpointPath
+        << ", render: " << ballRenderModeName(renderMode)
+        << ", instance stream: " << (ballRenderer.persistentInstances() ? "persistent" : "orphaning") << std::endl;
+
+    TextOverlay overlay;
+
+    FILE* statsFile = stdout;
+    if (!statsPath.empty()) {
+        statsFile = std::fopen(statsPath.c_str(), "w");
+        if (!statsFile) {
+            std::cerr << "Cannot write stats to " << statsPath << std::endl;
+            statsFile = stdout;
+        }
+    }
+    StatsLog statsLog;
+    statsLog.start(statsFile, statsFormat, statsHz);
+    StatsSample stats;
+    const double startTime = glfwGetTime();
 
     glUseProgram(shaderProgram);
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
+    // Realtime: loopt de schijf achter, dan vallen frames weg in plaats van dat de simulatie wacht
+    TrajectoryRecorder recorder;
+    if (!recordPath.empty()) {
+        std::string error;
+        if (!recorder.start(recordPath, recordKeyframe, TrajectoryOverflow::Drop, error)) {
+            std::cerr << "Cannot record trajectory: " << error << std::endl;
+            return 1;
+        }
+        recorder.record(sim);
+    }
+
+    // Vanaf hier zijn sim en eventSim van de simulatiethread
+    SimulationThread simThread(sim, eventSim, eventDriven, simHz, simCommands);
+    simThread.setCheckpointPath(checkpointPath);
+    if (recorder.recording()) simThread.setRecorder(&recorder);
+    simThread.start();
+    uint64_t lastStepCount = 0;
+
+    double lastFrameTime = glfwGetTime();
+#ifdef BALLS_PROFILE
+    double lastSummaryTime = lastFrameTime;
+#endif
+#ifdef BALLS_COUNT_ALLOCS
+    // De eerste frames vullen nog buffers en thread-locals
+    const uint64_t ALLOC_CHECK_WARMUP_FRAMES = 10;
+    size_t previousFrameBalls = 0;
+#endif
     while (!glfwWindowShouldClose(window)) {
+#ifdef BALLS_COUNT_ALLOCS
+        const uint64_t frameAllocStart = allocationCount();
+#endif
         glClearColor(0.05f, 0.05f, 0.1f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT);
 
-        // Reset?
-        if (resetRequested) {
-            balls = { { 0.0f, 0.0f, INITIAL_SPEED, INITIAL_SPEED } };
-            resetRequested = false;
-        }
-
-        // Update ballen
-        if (isRunning) {
-            std::vector<Ball> newBalls;
-
-            for (auto& ball : balls) {
-                ball.x += ball.vx;
-                ball.y += ball.vy;
-
-                float dist = std::sqrt(ball.x * ball.x + ball.y * ball.y);
-                if (dist + BALL_RADIUS >= CIRCLE_RADIUS) {
-                    float nx = ball.x / dist;
-                    float ny = ball.y / dist;
-                    float dot = ball.vx * nx + ball.vy * ny;
-                    ball.vx -= 2 * dot * nx;
-                    ball.vy -= 2 * dot * ny;
-                    ball.x -= nx * 0.001f;
-                    ball.y -= ny * 0.001f;
-
-                    float angle = static_cast<float>(rand()) / RAND_MAX * 2.0f * M_PI;
-                    newBalls.push_back({
-                        0.0f, 0.0f,
-                        INITIAL_SPEED * cos(angle),
-                        INITIAL_SPEED * sin(angle)
-                        });
-                }
-            }
+        if (renderModeToggled) {
+            ballRenderer.setMode(ballRenderer.getMode() == BallRenderMode::Fan ? BallRenderMode::Quad : BallRenderMode::Fan);
+            renderModeToggled = false;
+        }
+
+        // Nieuwste toestand van de simulatiethread; blijft staan tot de volgende acquire
+        double now = glfwGetTime();
+        double frameSeconds = now - lastFrameTime;
+        lastFrameTime = now;
+        simThread.acquire();
+        const SimSnapshot& snapshot = simThread.snapshot();
+        float alpha = snapshot.alpha(simClockSeconds());
+
+        // Ballen tekenen
+        {
+            PROFILE_SCOPE("draw");
+            glUseProgram(shaderProgram);
+            glBindVertexArray(circleVAO);
+            glUniform2f(offsetLoc, 0.0f, 0.0f);
+            glUniform3f(colorLoc, 0.2f, 0.4f, 0.7f);
+            glDrawArrays(GL_TRIANGLE_FAN, 0, CIRCLE_SEGMENTS + 2);
+
+            ballRenderer.draw(snapshot, alpha);
 
-            for (size_t i = 0; i < balls.size(); ++i) {
-                for (size_t j = i + 1; j < balls.size(); ++j) {
-                    float dx = balls[j].x - balls[i].x;
-                    float dy = balls[j].y - balls[i].y;
-                    float dist = std::sqrt(dx * dx + dy * dy);
-                    if (dist < 2 * BALL_RADIUS) {
-                        resolveBallCollision(balls[i], balls[j]);
-                    }
-                }
+            if (overlayVisible) {
+                char text[256];
+                int length = std::snprintf(text, sizeof(text),
+                    "BALLS %llu\nFPS %.1f  FRAME %.2f MS\nSIM %.2f MS  DRAW %.2f MS\nCOLLISIONS %llu",
+                    static_cast<unsigned long long>(stats.balls), stats.fps, stats.frameMs,
+                    stats.simMs, stats.drawMs, static_cast<unsigned long long>(stats.collisions));
+                // Alleen aan de grens: wandhits die geen bal meer opleveren
+                if (stats.spawnsDropped && length > 0 && static_cast<size_t>(length) < sizeof(text))
+                    std::snprintf(text + length, sizeof(text) - length, "\nBALL LIMIT: %llu SPAWNS DROPPED",
+                        static_cast<unsigned long long>(stats.spawnsDropped));
+                int fbWidth, fbHeight;
+                glfwGetFramebufferSize(window, &fbWidth, &fbHeight);
+                overlay.draw(text, fbWidth, fbHeight);
             }
+        }
+        double drawEnd = glfwGetTime();
+
+        // Statistieken naar de achtergrondthread; die schrijft ze naar de console.
+        // De simulatietellers komen uit de snapshot en horen bij de laatste ronde stappen.
+        stats.time = now - startTime;
+        ++stats.frame;
+        stats.balls = snapshot.count;
+        stats.frameMs = static_cast<float>(frameSeconds * 1000.0);
+        if (frameSeconds > 0.0)
+            stats.fps = stats.fps > 0.0f ? stats.fps * 0.95f + 0.05f * static_cast<float>(1.0 / frameSeconds)
+                                         : static_cast<float>(1.0 / frameSeconds);
+        stats.simMs = snapshot.simMs;
+        stats.drawMs = static_cast<float>((drawEnd - now) * 1000.0);
+        stats.steps = static_cast<uint32_t>(snapshot.stepCount >= lastStepCount ? snapshot.stepCount - lastStepCount : snapshot.stepCount);
+        lastStepCount = snapshot.stepCount;
+        stats.pairTests = snapshot.pairTests;
+        stats.collisions = snapshot.collisions;
+        stats.rebuilds = snapshot.rebuilds;
+        stats.spawnsDropped = snapshot.spawnsDropped;
+        stats.simPhases = snapshot.phases;
+        statsLog.push(stats);
 
-            balls.insert(balls.end(), newBalls.begin(), newBalls.end());
+#ifdef BALLS_COUNT_ALLOCS
+        // Zodra de populatie niet meer groeit hoort een frame niets te alloceren.
+        // Buffers volgen de groei een frame later, vandaar ook het vorige frame.
+        // De simulatiethread controleert zijn eigen rondes.
+        if (stats.frame > ALLOC_CHECK_WARMUP_FRAMES && snapshot.count == previousFrameBalls) {
+            const uint64_t frameAllocs = allocationCount() - frameAllocStart;
+            if (frameAllocs != 0)
+                std::cerr << "Frame " << stats.frame << ": " << frameAllocs << " heap allocations" << std::endl;
+            assert(frameAllocs == 0 && "heap allocation in steady-state frame");
         }
+        previousFrameBalls = snapshot.count;
+#endif
 
-        // Ballen tekenen
-        glBindVertexArray(circleVAO);
-        glUniform2f(offsetLoc, 0.0f, 0.0f);
-        glUniform3f(colorLoc, 0.2f, 0.4f, 0.7f);
-        glDrawArrays(GL_TRIANGLE_FAN, 0, CIRCLE_SEGMENTS + 2);
-
-        glBindVertexArray(ballVAO);
-        for (size_t i = 0; i < balls.size(); ++i) {
-            const auto& ball = balls[i];
-            if (i % 10 == 0)
-                glUniform3f(colorLoc, 0.2f, 1.0f, 0.5f);
-            else
-                glUniform3f(colorLoc, 1.0f, 0.5f, 0.2f);
-            glUniform2f(offsetLoc, ball.x, ball.y);
-            glDrawArrays(GL_TRIANGLE_FAN, 0, CIRCLE_SEGMENTS + 2);
+#ifdef BALLS_PROFILE
+        // Komt met de volgende push in de StatsLog-ring
+        if (now - lastSummaryTime >= 1.0) {
+            profilerPhases(stats.renderPhases);
+            lastSummaryTime = now;
         }
+#endif
 
-        // Print het aantal ballen in de console
-        std::cout << "Ball count: " << balls.size() << std::endl;
+        {
+            PROFILE_SCOPE("swap");
+            glfwSwapBuffers(window);
+        }
+        {
+            PROFILE_SCOPE("poll");
+            glfwPollEvents();
+        }
+    }
+    simThread.stop();
 
-        glfwSwapBuffers(window);
-        glfwPollEvents();
+    if (recorder.recording()) {
+        recorder.stop();
+        std::cout << "Recorded " << recorder.framesWritten() << " frames (" << recorder.framesDropped()
+            << " dropped, " << recorder.bytesWritten() << " bytes) to " << recordPath << std::endl;
     }
 
+    if (!tracePath.empty() && !profilerWriteChromeTrace(tracePath.c_str()))
+        std::cerr << "Cannot write trace " << tracePath << std::endl;
+
+    statsLog.stop();
+    if (statsFile != stdout) std::fclose(statsFile);
+
+    overlay.destroy();
+    ballRenderer.destroy();
     glfwTerminate();
     return 0;
 }